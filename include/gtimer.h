@@ -7,6 +7,8 @@
 #define GTIMER_H_
 
 #include <gimxpoll/include/gpoll.h>
+#include <gimxtime/include/gtime.h>
+#include <stdint.h>
 
 #ifndef WIN32
 typedef GPOLL_REGISTER_FD GTIMER_REGISTER_SOURCE;
@@ -23,15 +25,103 @@ typedef struct {
     GTIMER_REMOVE_SOURCE fp_remove;     // to remove the timer from event sources
 } GTIMER_CALLBACKS;
 
+/*
+ * Called once per wakeup of a batched timer, for the logical ticks elapsed since the previous call.
+ * Tick i (0 <= i < count) is due at first + i * period.
+ */
+typedef int (* GTIMER_BATCH_CALLBACK)(void * user, gtime first, gtime period, unsigned int count);
+
+typedef struct {
+    unsigned int ratio;             // logical ticks per wakeup: higher values lower the wakeup rate and the CPU usage
+    GTIMER_BATCH_CALLBACK fp_batch; // called once per wakeup, if NULL fp_read is called ratio times in a row at each wakeup
+} GTIMER_BATCH;
+
+typedef struct {
+    double bandwidth;     // loop bandwidth, as a fraction of the event rate, in ]0, 0.1], e.g. 0.02
+    gtimediff offset;     // desired time of the timer ticks relative to the external events, in nanoseconds
+    gtime lock_threshold; // phase error under which the loop is locked, in nanoseconds (0 = 1% of the period)
+} GTIMER_PLL;
+
+typedef struct {
+    int locked;
+    gtime period;    // current period estimate, in nanoseconds
+    gtimediff error; // phase error measured at the last external event, in nanoseconds
+} GTIMER_PLL_STATUS;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 struct gtimer;
+struct gtimeout;
 
 struct gtimer * gtimer_start(void * user, unsigned int usec, const GTIMER_CALLBACKS * callbacks);
+
+/*
+ * Start a timer with a period of nsec nanoseconds, or of num / den seconds (den <= UINT32_MAX).
+ * Fractional nanoseconds are distributed over the periods, so that each deadline
+ * is within 1ns of the ideal one and the long-run rate is exact.
+ * On Windows the timer still fires on the system timer resolution grid, but the period is not rounded.
+ */
+struct gtimer * gtimer_start_ns(void * user, uint64_t nsec, const GTIMER_CALLBACKS * callbacks);
+struct gtimer * gtimer_start_rational(void * user, uint64_t num, uint64_t den, const GTIMER_CALLBACKS * callbacks);
 int gtimer_close(struct gtimer * timer);
 
+/*
+ * Start a timeout that calls fp_read once, if it is not reset within usec microseconds.
+ * An expired timeout is started again by gtimeout_reset().
+ * Resets make no system call and no allocation, which suits timeouts that are pushed back very often.
+ * All timeouts share the same event source, registered with the callbacks of the first timeout.
+ */
+struct gtimeout * gtimeout_start(void * user, unsigned int usec, const GTIMER_CALLBACKS * callbacks);
+int gtimeout_reset(struct gtimeout * timeout);
+int gtimeout_close(struct gtimeout * timeout);
+
+/*
+ * Start a timer with a logical period of nsec nanoseconds, that wakes up every batch->ratio ticks.
+ * This allows tick rates above what the process can be woken up at.
+ * Without fp_batch, the ticks of a wakeup are not spread: fp_read is called in a burst, and missed wakeups
+ * are coalesced as for other timers, so that there are at most batch->ratio calls per wakeup.
+ */
+struct gtimer * gtimer_start_batched(void * user, gtime nsec, const GTIMER_BATCH * batch, const GTIMER_CALLBACKS * callbacks);
+
+/*
+ * Start a timer that locks its period and phase onto an external event stream,
+ * whose cadence is close to usec microseconds.
+ * The timestamps of the external events are fed with gtimer_pll_event().
+ */
+struct gtimer * gtimer_start_pll(void * user, unsigned int usec, const GTIMER_PLL * pll, const GTIMER_CALLBACKS * callbacks);
+int gtimer_pll_event(struct gtimer * timer, gtime timestamp);
+int gtimer_pll_get_status(struct gtimer * timer, GTIMER_PLL_STATUS * status);
+
+/*
+ * Start a timer that shares its wakeups with all the timers started with the same name and period,
+ * in this process or in other ones (Linux only).
+ * The first timer owns the kernel timer, the other ones are signaled when it expires.
+ * Only the processes of the same effective user can share a tick source.
+ * When the owner is closed, the other timers elect a new owner, fp_close is only called if this fails.
+ * The election does not block: if the owner is starting or leaving, the timer joins later, or fp_close is called.
+ */
+struct gtimer * gtimer_start_shared(void * user, const char * name, unsigned int usec, const GTIMER_CALLBACKS * callbacks);
+
+/*
+ * Select the kernel timer implementation used by the timers started afterwards (Linux only):
+ * - "timerfd" (default)
+ * - "posix": timer_create() with a per-timer real-time signal read from a signalfd,
+ *   timers have to be started and polled from the same thread,
+ *   real-time signals that the application handles or blocks are not used
+ * - "condvar": a thread per timer, waiting on a condition variable and signaling an eventfd
+ * The GTIMER_BACKEND environment variable selects the initial implementation.
+ */
+int gtimer_set_backend(const char * name);
+
+/*
+ * Publish per-timer statistics in a named shared-memory segment (see gtimer_stats.h).
+ * The name follows shm_open() conventions, e.g. "/gimx-timers".
+ */
+int gtimer_stats_open(const char * name);
+void gtimer_stats_close();
+
 #ifdef __cplusplus
 }
 #endif
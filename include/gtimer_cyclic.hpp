@@ -0,0 +1,256 @@
+/*
+ Copyright (c) 2026 Mathieu Laurendeau <mat.lau@laposte.net>
+ License: GPLv3
+ */
+
+#ifndef GTIMER_CYCLIC_HPP_
+#define GTIMER_CYCLIC_HPP_
+
+/*
+ * A cyclic executive for a set of periods known at compile time (C++14).
+ *
+ * The base tick is the greatest common divisor of the periods, and the hyperperiod is their least
+ * common multiple. The tasks to run at each base tick of the hyperperiod (a minor frame) are stored
+ * in a table of bitmasks computed at compile time, so that the whole set runs from a single timer,
+ * with a table lookup per tick.
+ *
+ * The base timer is a batched timer with a ratio of 1, so that missed base ticks are reported and
+ * the frames stay aligned. Tasks whose period was missed run once, as with individual timers.
+ * On Windows, where batched timers are not supported and missed periods are coalesced, the base timer
+ * is a regular timer, and the frames to run are given by the time elapsed since the start.
+ *
+ * Example:
+ *
+ *   static gtimer_cyclic<1000, 2000, 5000> executive; // periods in microseconds
+ *   GTIMER_TASK tasks[] = { { user1, read1 }, { user2, read2 }, { user3, read3 } };
+ *   executive.start(tasks, user, &callbacks); // callbacks.fp_read is not used
+ */
+
+#include "gtimer.h"
+#include <stdint.h>
+#include <type_traits>
+
+typedef struct {
+    void * user;
+    GPOLL_READ_CALLBACK fp_read;
+} GTIMER_TASK;
+
+namespace gtimer_cyclic_detail {
+
+constexpr uint64_t gcd(uint64_t a, uint64_t b) {
+    return b ? gcd(b, a % b) : a;
+}
+
+constexpr uint64_t gcd_all(const uint64_t * values, unsigned int count) {
+    uint64_t result = 0;
+    for (unsigned int i = 0; i < count; ++i) {
+        result = gcd(result, values[i]);
+    }
+    return result;
+}
+
+constexpr uint64_t lcm_all(const uint64_t * values, unsigned int count) {
+    uint64_t result = 1;
+    for (unsigned int i = 0; i < count; ++i) {
+        result = result / gcd(result, values[i]) * values[i];
+    }
+    return result;
+}
+
+template <typename MASK, unsigned int FRAMES>
+struct table {
+    MASK masks[FRAMES];
+};
+
+// frame 0 is the end of the hyperperiod, where all tasks run
+template <typename MASK, unsigned int FRAMES>
+constexpr table<MASK, FRAMES> make_table(const uint64_t * periods, unsigned int count, uint64_t base) {
+    table<MASK, FRAMES> result = {};
+    for (unsigned int i = 0; i < count; ++i) {
+        for (unsigned int frame = 0; frame < FRAMES; frame += periods[i] / base) {
+            result.masks[frame] |= (MASK) 1 << i;
+        }
+    }
+    return result;
+}
+
+}
+
+// maximum number of minor frames, to bound the table size and the compilation time
+#define GTIMER_CYCLIC_MAX_FRAMES 65536
+
+template <unsigned int... PERIODS>
+class gtimer_cyclic {
+
+    static constexpr unsigned int count = sizeof...(PERIODS);
+    static constexpr uint64_t periods[count] = { PERIODS... };
+
+    static_assert(count > 0 && count <= 64, "the number of periods should be in [1, 64]");
+    static_assert(gtimer_cyclic_detail::gcd_all(periods, count) > 0, "periods cannot be 0");
+
+public:
+    static constexpr uint64_t base = gtimer_cyclic_detail::gcd_all(periods, count); // in microseconds
+    static constexpr uint64_t hyperperiod = gtimer_cyclic_detail::lcm_all(periods, count); // in microseconds
+    static constexpr uint64_t frames = hyperperiod / base;
+
+    static_assert(frames <= GTIMER_CYCLIC_MAX_FRAMES, "the hyperperiod is too long compared to the base tick");
+
+private:
+    typedef typename std::conditional<count <= 32, uint32_t, uint64_t>::type mask_t;
+
+    static constexpr gtimer_cyclic_detail::table<mask_t, frames> table =
+        gtimer_cyclic_detail::make_table<mask_t, frames>(periods, count, base);
+
+    GTIMER_TASK tasks[count];
+    unsigned int frame = 0;
+    struct gtimer * timer = nullptr;
+    void * user = nullptr;
+    GPOLL_CLOSE_CALLBACK fp_close = nullptr;
+#ifdef WIN32
+    gtime start_time = 0;
+    uint64_t ticks = 0; // base ticks since the start
+#endif
+
+    /*
+     * Run the tasks of the next nexp frames, tasks of missed frames run once.
+     */
+    static int run(gtimer_cyclic * executive, unsigned int nexp) {
+
+        mask_t mask = 0;
+        unsigned int frame = executive->frame;
+        if (nexp < frames) {
+            for (unsigned int i = 0; i < nexp; ++i) {
+                if (++frame == frames) {
+                    frame = 0;
+                }
+                mask |= table.masks[frame];
+            }
+        } else {
+            // a whole hyperperiod was missed, all tasks run
+            mask = table.masks[0];
+            frame = (frame + nexp % frames) % frames;
+        }
+        executive->frame = frame;
+
+        int ret = 0;
+
+        while (mask) {
+            unsigned int index = sizeof(mask) > 4 ? __builtin_ctzll(mask) : __builtin_ctz(mask);
+            mask &= mask - 1;
+            const GTIMER_TASK & task = executive->tasks[index];
+            int status = task.fp_read(task.user);
+            if (status < 0) {
+                ret = -1;
+            } else if (ret != -1 && status) {
+                ret = 1;
+            }
+        }
+
+        return ret;
+    }
+
+#ifndef WIN32
+    static int batch_callback(void * user, gtime first __attribute__((unused)), gtime period __attribute__((unused)),
+            unsigned int nexp) {
+
+        return run(static_cast<gtimer_cyclic *>(user), nexp);
+    }
+#else
+    static int read_callback(void * user) {
+
+        gtimer_cyclic * executive = static_cast<gtimer_cyclic *>(user);
+
+        // the timer may fire a bit early, as its period is rounded to the timer resolution
+        uint64_t ticks = (gtime_gettime() - executive->start_time + base * 500) / (base * 1000);
+        if (ticks <= executive->ticks) {
+            return 0;
+        }
+
+        // keep the position in the hyperperiod if it does not fit
+        uint64_t elapsed = ticks - executive->ticks;
+        unsigned int nexp = elapsed < frames ? elapsed : frames + elapsed % frames;
+        executive->ticks = ticks;
+
+        return run(executive, nexp);
+    }
+#endif
+
+    static int close_callback(void * user) {
+
+        gtimer_cyclic * executive = static_cast<gtimer_cyclic *>(user);
+
+        return executive->fp_close(executive->user);
+    }
+
+public:
+    /*
+     * The tasks that run in a frame, as a bitmask in the order of the periods.
+     */
+    static constexpr mask_t mask(unsigned int frame) {
+        return table.masks[frame];
+    }
+
+    /*
+     * Start the executive, tasks are given in the order of the periods.
+     * The user pointer of the callbacks is given to fp_close.
+     */
+    int start(const GTIMER_TASK (&tasks)[count], void * user, const GTIMER_CALLBACKS * callbacks) {
+
+        if (timer != nullptr) {
+            return -1;
+        }
+
+        for (unsigned int i = 0; i < count; ++i) {
+            if (tasks[i].fp_read == nullptr) {
+                return -1;
+            }
+            this->tasks[i] = tasks[i];
+        }
+
+        this->user = user;
+        fp_close = callbacks->fp_close;
+        frame = 0;
+
+        GTIMER_CALLBACKS timer_callbacks = *callbacks;
+        timer_callbacks.fp_read = nullptr;
+        timer_callbacks.fp_close = close_callback;
+
+#ifndef WIN32
+        GTIMER_BATCH batch = { 1, batch_callback };
+
+        timer = gtimer_start_batched(this, base * 1000, &batch, &timer_callbacks);
+#else
+        timer_callbacks.fp_read = read_callback;
+        start_time = gtime_gettime();
+        ticks = 0;
+
+        timer = gtimer_start(this, base, &timer_callbacks);
+#endif
+
+        return timer != nullptr ? 0 : -1;
+    }
+
+    int close() {
+
+        if (timer == nullptr) {
+            return 0;
+        }
+
+        int ret = gtimer_close(timer);
+        timer = nullptr;
+        return ret;
+    }
+
+    ~gtimer_cyclic() {
+        close();
+    }
+};
+
+template <unsigned int... PERIODS>
+constexpr uint64_t gtimer_cyclic<PERIODS...>::periods[];
+
+template <unsigned int... PERIODS>
+constexpr gtimer_cyclic_detail::table<typename gtimer_cyclic<PERIODS...>::mask_t, gtimer_cyclic<PERIODS...>::frames>
+    gtimer_cyclic<PERIODS...>::table;
+
+#endif /* GTIMER_CYCLIC_HPP_ */
@@ -0,0 +1,71 @@
+/*
+ Copyright (c) 2026 Mathieu Laurendeau <mat.lau@laposte.net>
+ License: GPLv3
+ */
+
+#ifndef GTIMER_STATS_H_
+#define GTIMER_STATS_H_
+
+/*
+ * Layout of the shared-memory segment published by gtimer_stats_open().
+ *
+ * The segment is written by the monitored process only. Each timer slot is protected by a sequence
+ * counter: the writer makes it odd before updating the slot and even again afterwards, so that readers
+ * can detect and retry torn reads without any locking on the writer side.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#define GTIMER_STATS_MAGIC 0x474d5452 // "GTMR"
+#define GTIMER_STATS_VERSION 1
+
+#define GTIMER_STATS_MAX_TIMERS 64
+
+// lateness histogram: bucket 0 is [0, 1us), bucket i is [2^(i-1)us, 2^i us), last bucket is open-ended
+#define GTIMER_STATS_LATENESS_BUCKETS 16
+
+struct gtimer_stats_timer {
+    uint32_t seq;      // odd while the slot is being updated
+    uint32_t active;   // non-zero if the slot is used by a running timer
+    uint64_t period;   // timer period, in nanoseconds
+    uint64_t count;    // number of timer events delivered
+    uint64_t missed;   // number of timer expirations that were not delivered
+    uint64_t lateness[GTIMER_STATS_LATENESS_BUCKETS];
+    uint64_t cb_total; // time spent in the read callback, in nanoseconds
+    uint64_t cb_max;   // longest read callback, in nanoseconds
+};
+
+struct gtimer_stats {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t pid;
+    uint32_t max_timers;
+    struct gtimer_stats_timer timers[GTIMER_STATS_MAX_TIMERS];
+};
+
+// number of attempts to read a slot, a writer that died during an update leaves the slot inconsistent
+#define GTIMER_STATS_READ_RETRIES 1000
+
+/*
+ * Get a consistent copy of a timer slot.
+ * This is meant to be used by external readers of the segment.
+ * Returns 0 on success, or -1 if no consistent copy could be read.
+ */
+static inline int gtimer_stats_read(const struct gtimer_stats_timer * src, struct gtimer_stats_timer * dst) {
+
+    unsigned int retry;
+    for (retry = 0; retry < GTIMER_STATS_READ_RETRIES; ++retry) {
+        uint32_t begin = __atomic_load_n(&src->seq, __ATOMIC_ACQUIRE);
+        memcpy(dst, (const void *) src, sizeof(*dst));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t end = __atomic_load_n(&src->seq, __ATOMIC_RELAXED);
+        if (!(begin & 1) && begin == end) {
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+#endif /* GTIMER_STATS_H_ */
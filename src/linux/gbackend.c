@@ -0,0 +1,66 @@
+/*
+ Copyright (c) 2026 Mathieu Laurendeau <mat.lau@laposte.net>
+ License: GPLv3
+ */
+
+#include "gbackend.h"
+#include <gimxlog/include/glog.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+GLOG_GET(GLOG_NAME)
+
+static const GTIMER_BACKEND * backends[] = {
+    &gbackend_timerfd,
+    &gbackend_posix,
+    &gbackend_condvar,
+};
+
+static const GTIMER_BACKEND * current = NULL;
+
+static const GTIMER_BACKEND * find(const char * name) {
+
+    unsigned int i;
+    for (i = 0; i < sizeof(backends) / sizeof(*backends); ++i) {
+        if (strcmp(backends[i]->name, name) == 0) {
+            return backends[i];
+        }
+    }
+
+    if (GLOG_LEVEL(GLOG_NAME,ERROR)) {
+        fprintf(stderr, "%s:%d %s: unknown timer backend: %s\n", __FILE__, __LINE__, __func__, name);
+    }
+
+    return NULL;
+}
+
+const GTIMER_BACKEND * gbackend_get() {
+
+    if (current == NULL) {
+        const char * name = getenv("GTIMER_BACKEND");
+        if (name != NULL) {
+            current = find(name);
+        }
+        if (current == NULL) {
+            current = backends[0];
+        }
+        if (GLOG_LEVEL(GLOG_NAME,DEBUG)) {
+            printf("timer backend: %s\n", current->name);
+        }
+    }
+
+    return current;
+}
+
+int gbackend_select(const char * name) {
+
+    const GTIMER_BACKEND * backend = find(name);
+    if (backend == NULL) {
+        return -1;
+    }
+
+    current = backend;
+
+    return 0;
+}
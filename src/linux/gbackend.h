@@ -0,0 +1,39 @@
+/*
+ Copyright (c) 2026 Mathieu Laurendeau <mat.lau@laposte.net>
+ License: GPLv3
+ */
+
+#ifndef GBACKEND_H_
+#define GBACKEND_H_
+
+#include <gimxtime/include/gtime.h>
+#include <stdint.h>
+
+/*
+ * A timer source is a kernel timer that makes a file descriptor readable on expiration.
+ * Times are absolute CLOCK_MONOTONIC times, in nanoseconds.
+ *
+ * read() never blocks: a source may be set again after it was reported readable,
+ * which drops the pending expirations, and 0 expirations are then reported.
+ */
+typedef struct {
+    const char * name;
+    void * (* open)(); // create a disarmed timer source
+    int (* get_fd)(void * source); // the file descriptor to poll
+    int (* settime)(void * source, gtime value, gtime interval); // a value of 0 disarms the timer
+    int (* read)(void * source, uint64_t * nexp); // get the number of expirations since the last read, 0 if none
+    void (* close)(void * source);
+} GTIMER_BACKEND;
+
+extern const GTIMER_BACKEND gbackend_timerfd;
+extern const GTIMER_BACKEND gbackend_posix;
+extern const GTIMER_BACKEND gbackend_condvar;
+
+/*
+ * Get the backend for new timers.
+ * Unless gbackend_select() was called, it is selected by the GTIMER_BACKEND environment variable.
+ */
+const GTIMER_BACKEND * gbackend_get();
+int gbackend_select(const char * name);
+
+#endif /* GBACKEND_H_ */
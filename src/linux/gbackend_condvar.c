@@ -0,0 +1,187 @@
+/*
+ Copyright (c) 2026 Mathieu Laurendeau <mat.lau@laposte.net>
+ License: GPLv3
+ */
+
+#include "gbackend.h"
+#include <gimxcommon/include/gerror.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/*
+ * Each source is a thread that waits for the next expiration on a condition variable
+ * that uses CLOCK_MONOTONIC, and adds the number of expirations to an eventfd.
+ *
+ * Setting the timer only updates the schedule and signals the condition variable:
+ * the thread reads the schedule again each time it wakes up, and only writes to the eventfd
+ * with the mutex held, so that no expiration of a previous setting can be added afterwards.
+ */
+
+struct source {
+    int fd;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    gtime value;
+    gtime interval;
+    int stop;
+};
+
+static inline gtime now() {
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void * timer_thread(void * user) {
+
+    struct source * source = (struct source *) user;
+
+    pthread_mutex_lock(&source->mutex);
+
+    while (!source->stop) {
+
+        if (source->value == 0) {
+            pthread_cond_wait(&source->cond, &source->mutex);
+            continue;
+        }
+
+        gtime current = now();
+
+        if (current < source->value) {
+            struct timespec ts = { .tv_sec = source->value / 1000000000, .tv_nsec = source->value % 1000000000 };
+            pthread_cond_timedwait(&source->cond, &source->mutex, &ts);
+            continue;
+        }
+
+        uint64_t nexp = 1;
+        if (source->interval) {
+            nexp += (current - source->value) / source->interval;
+            source->value += nexp * source->interval;
+        } else {
+            source->value = 0;
+        }
+
+        if (write(source->fd, &nexp, sizeof(nexp)) != sizeof(nexp)) {
+            PRINT_ERROR_ERRNO("write");
+        }
+    }
+
+    pthread_mutex_unlock(&source->mutex);
+
+    return NULL;
+}
+
+static void * source_open() {
+
+    struct source * source = calloc(1, sizeof(*source));
+    if (source == NULL) {
+        PRINT_ERROR_ALLOC_FAILED("calloc");
+        return NULL;
+    }
+
+    source->fd = eventfd(0, EFD_NONBLOCK);
+    if (source->fd < 0) {
+        PRINT_ERROR_ERRNO("eventfd");
+        free(source);
+        return NULL;
+    }
+
+    pthread_mutex_init(&source->mutex, NULL);
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&source->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    int ret = pthread_create(&source->thread, NULL, timer_thread, source);
+    if (ret) {
+        errno = ret;
+        PRINT_ERROR_ERRNO("pthread_create");
+        pthread_cond_destroy(&source->cond);
+        pthread_mutex_destroy(&source->mutex);
+        close(source->fd);
+        free(source);
+        return NULL;
+    }
+
+    return source;
+}
+
+static int source_get_fd(void * user) {
+
+    struct source * source = (struct source *) user;
+
+    return source->fd;
+}
+
+static int source_settime(void * user, gtime value, gtime interval) {
+
+    struct source * source = (struct source *) user;
+
+    pthread_mutex_lock(&source->mutex);
+
+    source->value = value;
+    source->interval = interval;
+
+    // like a timerfd, drop the expirations of the previous setting
+    uint64_t nexp;
+    if (read(source->fd, &nexp, sizeof(nexp)) < 0 && errno != EAGAIN) {
+        PRINT_ERROR_ERRNO("read");
+    }
+
+    pthread_cond_signal(&source->cond);
+
+    pthread_mutex_unlock(&source->mutex);
+
+    return 0;
+}
+
+static int source_read(void * user, uint64_t * nexp) {
+
+    struct source * source = (struct source *) user;
+
+    if (read(source->fd, nexp, sizeof(*nexp)) != sizeof(*nexp)) {
+        if (errno == EAGAIN) {
+            *nexp = 0;
+            return 0;
+        }
+        PRINT_ERROR_ERRNO("read");
+        return -1;
+    }
+
+    return 0;
+}
+
+static void source_close(void * user) {
+
+    struct source * source = (struct source *) user;
+
+    pthread_mutex_lock(&source->mutex);
+    source->stop = 1;
+    pthread_cond_signal(&source->cond);
+    pthread_mutex_unlock(&source->mutex);
+
+    pthread_join(source->thread, NULL);
+
+    pthread_cond_destroy(&source->cond);
+    pthread_mutex_destroy(&source->mutex);
+    close(source->fd);
+    free(source);
+}
+
+const GTIMER_BACKEND gbackend_condvar = {
+    .name = "condvar",
+    .open = source_open,
+    .get_fd = source_get_fd,
+    .settime = source_settime,
+    .read = source_read,
+    .close = source_close,
+};
@@ -0,0 +1,222 @@
+/*
+ Copyright (c) 2026 Mathieu Laurendeau <mat.lau@laposte.net>
+ License: GPLv3
+ */
+
+#include "gbackend.h"
+#include <gimxcommon/include/gerror.h>
+#include <sys/signalfd.h>
+#include <sys/syscall.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+/*
+ * Each source is a POSIX timer that sends its own real-time signal to the thread that created it.
+ * The signal is blocked in this thread and read from a signalfd, so timers have to be
+ * created and polled from the same thread.
+ * Real-time signals are allocated from SIGRTMIN, skipping the ones the application handles or blocks,
+ * which limits the number of timers to SIGRTMAX - SIGRTMIN + 1.
+ */
+
+struct source {
+    timer_t timerid;
+    int signo;
+    int fd;
+};
+
+static uint64_t signals = 0; // signals in use, bit i is SIGRTMIN + i
+
+/*
+ * Check if the application uses a signal.
+ */
+static int signal_used(int signo) {
+
+    struct sigaction sa;
+    if (sigaction(signo, NULL, &sa) < 0) {
+        return 1;
+    }
+
+    if ((sa.sa_flags & SA_SIGINFO) || (sa.sa_handler != SIG_DFL && sa.sa_handler != SIG_IGN)) {
+        return 1;
+    }
+
+    sigset_t mask;
+    pthread_sigmask(SIG_BLOCK, NULL, &mask);
+
+    return sigismember(&mask, signo);
+}
+
+static int signal_alloc() {
+
+    int i;
+    for (i = 0; i <= SIGRTMAX - SIGRTMIN && i < 64; ++i) {
+        if (!(signals & (1ULL << i)) && !signal_used(SIGRTMIN + i)) {
+            signals |= (1ULL << i);
+            return SIGRTMIN + i;
+        }
+    }
+
+    PRINT_ERROR_OTHER("no real-time signal left");
+    return -1;
+}
+
+static void signal_free(int signo) {
+
+    signals &= ~(1ULL << (signo - SIGRTMIN));
+}
+
+/*
+ * Read pending expirations, returns 0 if there is none.
+ */
+static int drain(struct source * source, uint64_t * nexp) {
+
+    struct signalfd_siginfo info;
+
+    *nexp = 0;
+
+    for (;;) {
+        ssize_t res = read(source->fd, &info, sizeof(info));
+        if (res < 0 && errno == EAGAIN) {
+            return 0;
+        }
+        if (res != sizeof(info)) {
+            PRINT_ERROR_ERRNO("read");
+            return -1;
+        }
+        *nexp += 1 + info.ssi_overrun;
+    }
+}
+
+static void * source_open() {
+
+    struct source * source = calloc(1, sizeof(*source));
+    if (source == NULL) {
+        PRINT_ERROR_ALLOC_FAILED("calloc");
+        return NULL;
+    }
+
+    source->signo = signal_alloc();
+    if (source->signo < 0) {
+        free(source);
+        return NULL;
+    }
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, source->signo);
+
+    int ret = pthread_sigmask(SIG_BLOCK, &mask, NULL);
+    if (ret) {
+        errno = ret;
+        PRINT_ERROR_ERRNO("pthread_sigmask");
+        signal_free(source->signo);
+        free(source);
+        return NULL;
+    }
+
+    source->fd = signalfd(-1, &mask, SFD_NONBLOCK);
+    if (source->fd < 0) {
+        PRINT_ERROR_ERRNO("signalfd");
+        signal_free(source->signo);
+        free(source);
+        return NULL;
+    }
+
+    struct sigevent sev = {
+            .sigev_notify = SIGEV_THREAD_ID,
+            .sigev_signo = source->signo,
+    };
+    sev.sigev_notify_thread_id = syscall(SYS_gettid);
+
+    if (timer_create(CLOCK_MONOTONIC, &sev, &source->timerid) < 0) {
+        PRINT_ERROR_ERRNO("timer_create");
+        close(source->fd);
+        signal_free(source->signo);
+        free(source);
+        return NULL;
+    }
+
+    return source;
+}
+
+static int source_get_fd(void * user) {
+
+    struct source * source = (struct source *) user;
+
+    return source->fd;
+}
+
+static int source_settime(void * user, gtime value, gtime interval) {
+
+    struct source * source = (struct source *) user;
+
+    struct itimerspec new_value = {
+            .it_interval = { .tv_sec = interval / 1000000000, .tv_nsec = interval % 1000000000 },
+            .it_value = { .tv_sec = value / 1000000000, .tv_nsec = value % 1000000000 },
+    };
+
+    // like a timerfd, drop the expirations of the previous setting:
+    // disarm the timer, then drop pending signals before arming the timer again
+    static const struct itimerspec disarm = {};
+    if (timer_settime(source->timerid, 0, &disarm, NULL) < 0) {
+        PRINT_ERROR_ERRNO("timer_settime");
+        return -1;
+    }
+
+    uint64_t nexp;
+    if (drain(source, &nexp) < 0) {
+        return -1;
+    }
+
+    if (timer_settime(source->timerid, TIMER_ABSTIME, &new_value, NULL) < 0) {
+        PRINT_ERROR_ERRNO("timer_settime");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int source_read(void * user, uint64_t * nexp) {
+
+    struct source * source = (struct source *) user;
+
+    return drain(source, nexp);
+}
+
+static void source_close(void * user) {
+
+    struct source * source = (struct source *) user;
+
+    timer_delete(source->timerid);
+    // drop a pending signal, so that it does not reach the next user of the signal number
+    uint64_t nexp;
+    drain(source, &nexp);
+    close(source->fd);
+
+    // the signal was not blocked before the source was opened, and none is pending
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, source->signo);
+    pthread_sigmask(SIG_UNBLOCK, &mask, NULL);
+
+    signal_free(source->signo);
+    free(source);
+}
+
+const GTIMER_BACKEND gbackend_posix = {
+    .name = "posix",
+    .open = source_open,
+    .get_fd = source_get_fd,
+    .settime = source_settime,
+    .read = source_read,
+    .close = source_close,
+};
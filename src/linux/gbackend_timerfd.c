@@ -0,0 +1,92 @@
+/*
+ Copyright (c) 2026 Mathieu Laurendeau <mat.lau@laposte.net>
+ License: GPLv3
+ */
+
+#include "gbackend.h"
+#include <gimxcommon/include/gerror.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+struct source {
+    int fd;
+};
+
+static void * source_open() {
+
+    struct source * source = calloc(1, sizeof(*source));
+    if (source == NULL) {
+        PRINT_ERROR_ALLOC_FAILED("calloc");
+        return NULL;
+    }
+
+    // the timer may be set again after it was reported readable, a read must not wait for the new setting
+    source->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if (source->fd < 0) {
+        PRINT_ERROR_ERRNO("timerfd_create");
+        free(source);
+        return NULL;
+    }
+
+    return source;
+}
+
+static int source_get_fd(void * user) {
+
+    struct source * source = (struct source *) user;
+
+    return source->fd;
+}
+
+static int source_settime(void * user, gtime value, gtime interval) {
+
+    struct source * source = (struct source *) user;
+
+    struct itimerspec new_value = {
+            .it_interval = { .tv_sec = interval / 1000000000, .tv_nsec = interval % 1000000000 },
+            .it_value = { .tv_sec = value / 1000000000, .tv_nsec = value % 1000000000 },
+    };
+
+    if (timerfd_settime(source->fd, TFD_TIMER_ABSTIME, &new_value, NULL)) {
+        PRINT_ERROR_ERRNO("timerfd_settime");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int source_read(void * user, uint64_t * nexp) {
+
+    struct source * source = (struct source *) user;
+
+    if (read(source->fd, nexp, sizeof(*nexp)) != sizeof(*nexp)) {
+        if (errno == EAGAIN) {
+            *nexp = 0;
+            return 0;
+        }
+        PRINT_ERROR_ERRNO("read");
+        return -1;
+    }
+
+    return 0;
+}
+
+static void source_close(void * user) {
+
+    struct source * source = (struct source *) user;
+
+    close(source->fd);
+    free(source);
+}
+
+const GTIMER_BACKEND gbackend_timerfd = {
+    .name = "timerfd",
+    .open = source_open,
+    .get_fd = source_get_fd,
+    .settime = source_settime,
+    .read = source_read,
+    .close = source_close,
+};
@@ -0,0 +1,755 @@
+/*
+ Copyright (c) 2026 Mathieu Laurendeau <mat.lau@laposte.net>
+ License: GPLv3
+ */
+
+#define _GNU_SOURCE // accept4, struct ucred
+
+#include "gshared.h"
+#include <gimxcommon/include/gerror.h>
+#include <gimxlog/include/glog.h>
+#include <gimxtime/include/gtime.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stddef.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+GLOG_GET(GLOG_NAME)
+
+/*
+ * A shared tick source is identified by a name and the effective user id.
+ *
+ * The owner is the timer that manages to bind the abstract unix socket "gtimer-<uid>-<name>".
+ * It runs a kernel timer, and publishes the tick count in the shared-memory segment "/gtimer-<uid>-<name>",
+ * which is created before the socket starts listening.
+ *
+ * The other timers are subscribers: they connect to the socket and send an eventfd, that the owner signals
+ * at each tick. The owner signals its own eventfd as well, so that all timers get their expirations
+ * the same way, from the tick count.
+ *
+ * As abstract sockets have no permissions, both ends check the credentials of their peer,
+ * and subscribers do not trust the tick count beyond the elapsed time.
+ *
+ * When the owner leaves, its subscribers elect a new owner among them. fp_close is only called if this fails.
+ */
+
+#define GSHARED_MAGIC 0x47534854 // "GSHT"
+
+#define GSHARED_OWNER 1
+#define GSHARED_SUBSCRIBER 2
+
+// an owner may be between bind() and listen(), or may leave between connect() and bind()
+#define ELECTION_ATTEMPTS 10
+#define ELECTION_DELAY 1000000 // delay between attempts, in nanoseconds
+
+struct segment {
+  uint32_t magic;
+  uint32_t pid;
+  uint64_t period;
+  uint64_t seq; // tick count
+};
+
+struct subscriber {
+  struct gshared * shared;
+  int sock;
+  int efd;
+};
+
+struct gshared {
+  struct sockaddr_un addr;
+  socklen_t len;
+  char shm_name[NAME_MAX];
+  gtime period;
+  int role; // 0 if the timer has no role
+  struct segment * segment;
+  int sock; // listening socket for the owner, connection for a subscriber
+  int registered; // if the socket is registered
+  int efd; // signaled at each tick
+  uint64_t last; // last tick count
+  gtime read_time; // time of the last read
+  void * user;
+  GPOLL_CLOSE_CALLBACK fp_close;
+  GTIMER_REGISTER_SOURCE fp_register;
+  GTIMER_REMOVE_SOURCE fp_remove;
+  const GTIMER_BACKEND * backend; // for the kernel timers
+  void * retry; // election timer
+  unsigned int attempts; // election attempts
+  // owner
+  void * source;
+  struct subscriber ** subscribers;
+  unsigned int nb_subscribers;
+};
+
+static int elect(struct gshared * shared);
+static void leave(struct gshared * shared);
+
+static void notify(int efd) {
+
+  uint64_t value = 1;
+  if (write(efd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+    PRINT_ERROR_ERRNO("write");
+  }
+}
+
+static int get_peer(int sock, struct ucred * cred) {
+
+  socklen_t len = sizeof(*cred);
+  if (getsockopt(sock, SOL_SOCKET, SO_PEERCRED, cred, &len) < 0) {
+    PRINT_ERROR_ERRNO("getsockopt");
+    return -1;
+  }
+
+  return 0;
+}
+
+static void subscriber_remove(struct subscriber * subscriber) {
+
+  struct gshared * shared = subscriber->shared;
+
+  unsigned int i;
+  for (i = 0; i < shared->nb_subscribers; ++i) {
+    if (shared->subscribers[i] == subscriber) {
+      shared->subscribers[i] = shared->subscribers[--shared->nb_subscribers];
+      break;
+    }
+  }
+
+  shared->fp_remove(subscriber->sock);
+  close(subscriber->sock);
+  if (subscriber->efd >= 0) {
+    close(subscriber->efd);
+  }
+  free(subscriber);
+}
+
+static int subscriber_close_callback(void * user) {
+
+  subscriber_remove((struct subscriber *) user);
+
+  return 0;
+}
+
+/*
+ * Receive the eventfd of a subscriber, or detect its departure.
+ */
+static int subscriber_read_callback(void * user) {
+
+  struct subscriber * subscriber = (struct subscriber *) user;
+
+  char data;
+  char control[CMSG_SPACE(sizeof(int))];
+  struct iovec iov = { .iov_base = &data, .iov_len = sizeof(data) };
+  struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1, .msg_control = control, .msg_controllen = sizeof(control) };
+
+  ssize_t res = recvmsg(subscriber->sock, &msg, MSG_CMSG_CLOEXEC);
+  if (res < 0 && errno == EAGAIN) {
+    return 0;
+  }
+  if (res <= 0) {
+    subscriber_remove(subscriber);
+    return 0;
+  }
+
+  struct cmsghdr * cmsg = CMSG_FIRSTHDR(&msg);
+  if (subscriber->efd < 0 && cmsg != NULL && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+    memcpy(&subscriber->efd, CMSG_DATA(cmsg), sizeof(int));
+  }
+
+  return 0;
+}
+
+static int close_callback(void * user) {
+
+  struct gshared * shared = (struct gshared *) user;
+
+  return shared->fp_close(shared->user);
+}
+
+/*
+ * Publish the expirations of the owner's kernel timer.
+ */
+static int tick_callback(void * user) {
+
+  struct gshared * shared = (struct gshared *) user;
+
+  uint64_t nexp;
+  if (shared->backend->read(shared->source, &nexp) < 0) {
+    return -1;
+  }
+
+  if (nexp == 0) {
+    return 0;
+  }
+
+  __atomic_store_n(&shared->segment->seq, shared->segment->seq + nexp, __ATOMIC_RELEASE);
+
+  unsigned int i;
+  for (i = 0; i < shared->nb_subscribers; ++i) {
+    if (shared->subscribers[i]->efd >= 0) {
+      notify(shared->subscribers[i]->efd);
+    }
+  }
+
+  notify(shared->efd);
+
+  return 0;
+}
+
+static int accept_read_callback(void * user) {
+
+  struct gshared * shared = (struct gshared *) user;
+
+  int sock = accept4(shared->sock, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+  if (sock < 0) {
+    if (errno != EAGAIN) {
+      PRINT_ERROR_ERRNO("accept4");
+    }
+    return 0;
+  }
+
+  struct ucred cred;
+  if (get_peer(sock, &cred) < 0 || cred.uid != geteuid()) {
+    close(sock);
+    return 0;
+  }
+
+  void * ptr = realloc(shared->subscribers, (shared->nb_subscribers + 1) * sizeof(*shared->subscribers));
+  struct subscriber * subscriber = calloc(1, sizeof(*subscriber));
+  if (ptr == NULL || subscriber == NULL) {
+    PRINT_ERROR_ALLOC_FAILED("calloc");
+    if (ptr != NULL) {
+      shared->subscribers = ptr;
+    }
+    free(subscriber);
+    close(sock);
+    return 0;
+  }
+  shared->subscribers = ptr;
+
+  subscriber->shared = shared;
+  subscriber->sock = sock;
+  subscriber->efd = -1;
+
+  GPOLL_CALLBACKS callbacks = {
+          .fp_read = subscriber_read_callback,
+          .fp_write = NULL,
+          .fp_close = subscriber_close_callback,
+  };
+  if (shared->fp_register(sock, subscriber, &callbacks) < 0) {
+    close(sock);
+    free(subscriber);
+    return 0;
+  }
+
+  shared->subscribers[shared->nb_subscribers++] = subscriber;
+
+  // the eventfd may already be queued
+  return subscriber_read_callback(subscriber);
+}
+
+/*
+ * The owner left: elect a new one.
+ */
+static int rejoin(struct gshared * shared) {
+
+  leave(shared);
+
+  if (elect(shared) < 0) {
+    return shared->fp_close(shared->user);
+  }
+
+  return 0;
+}
+
+static int owner_read_callback(void * user) {
+
+  struct gshared * shared = (struct gshared *) user;
+
+  char data;
+  ssize_t res = recv(shared->sock, &data, sizeof(data), 0);
+  if (res < 0 && errno == EAGAIN) {
+    return 0;
+  }
+
+  // the owner never sends anything, the connection is closed when it leaves
+  return rejoin(shared);
+}
+
+static int owner_close_callback(void * user) {
+
+  return rejoin((struct gshared *) user);
+}
+
+static struct segment * map_segment(const char * shm_name, int owner) {
+
+  // the owner holds the socket, so a segment left by a previous owner can be reused
+  int fd = shm_open(shm_name, owner ? O_CREAT | O_RDWR : O_RDONLY, 0600);
+  if (fd < 0) {
+    PRINT_ERROR_ERRNO("shm_open");
+    return NULL;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    PRINT_ERROR_ERRNO("fstat");
+    close(fd);
+    return NULL;
+  }
+
+  if (st.st_uid != geteuid()) {
+    PRINT_ERROR_OTHER("shared tick source segment belongs to another user");
+    close(fd);
+    return NULL;
+  }
+
+  if (owner && ftruncate(fd, sizeof(struct segment)) < 0) {
+    PRINT_ERROR_ERRNO("ftruncate");
+    close(fd);
+    return NULL;
+  }
+
+  if (!owner && (size_t) st.st_size < sizeof(struct segment)) {
+    PRINT_ERROR_OTHER("invalid shared tick source segment");
+    close(fd);
+    return NULL;
+  }
+
+  void * ptr = mmap(NULL, sizeof(struct segment), owner ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    PRINT_ERROR_ERRNO("mmap");
+    return NULL;
+  }
+
+  return ptr;
+}
+
+/*
+ * Called once the socket is bound.
+ */
+static int become_owner(struct gshared * shared) {
+
+  shared->role = GSHARED_OWNER;
+
+  // the segment is ready before subscribers can connect
+  shared->segment = map_segment(shared->shm_name, 1);
+  if (shared->segment == NULL) {
+    return -1;
+  }
+
+  shared->segment->magic = 0;
+  shared->segment->pid = getpid();
+  shared->segment->period = shared->period;
+  shared->segment->seq = 0;
+  __atomic_store_n(&shared->segment->magic, GSHARED_MAGIC, __ATOMIC_RELEASE);
+
+  shared->last = 0;
+
+  const GTIMER_BACKEND * backend = shared->backend;
+  void * source = backend->open();
+  if (source == NULL) {
+    return -1;
+  }
+
+  GPOLL_CALLBACKS tick_callbacks = {
+          .fp_read = tick_callback,
+          .fp_write = NULL,
+          .fp_close = close_callback,
+  };
+  if (backend->settime(source, gtime_gettime() + shared->period, shared->period) < 0
+      || shared->fp_register(backend->get_fd(source), shared, &tick_callbacks) < 0) {
+    backend->close(source);
+    return -1;
+  }
+
+  shared->source = source;
+
+  if (listen(shared->sock, SOMAXCONN) < 0) {
+    PRINT_ERROR_ERRNO("listen");
+    return -1;
+  }
+
+  GPOLL_CALLBACKS gpoll_callbacks = {
+          .fp_read = accept_read_callback,
+          .fp_write = NULL,
+          .fp_close = close_callback,
+  };
+  if (shared->fp_register(shared->sock, shared, &gpoll_callbacks) < 0) {
+    return -1;
+  }
+
+  shared->registered = 1;
+
+  return 0;
+}
+
+/*
+ * Called once the socket is connected.
+ */
+static int subscribe(struct gshared * shared) {
+
+  shared->role = GSHARED_SUBSCRIBER;
+
+  struct ucred cred;
+  if (get_peer(shared->sock, &cred) < 0) {
+    return -1;
+  }
+
+  if (cred.uid != geteuid()) {
+    PRINT_ERROR_OTHER("shared tick source is owned by another user");
+    return -1;
+  }
+
+  shared->segment = map_segment(shared->shm_name, 0);
+  if (shared->segment == NULL) {
+    return -1;
+  }
+
+  if (__atomic_load_n(&shared->segment->magic, __ATOMIC_ACQUIRE) != GSHARED_MAGIC
+      || shared->segment->pid != (uint32_t) cred.pid) {
+    PRINT_ERROR_OTHER("invalid shared tick source segment");
+    return -1;
+  }
+
+  if (shared->segment->period != shared->period) {
+    if (GLOG_LEVEL(GLOG_NAME,ERROR)) {
+      fprintf(stderr, "%s:%d %s: shared tick source period mismatch: %lluns (owner) vs %lluns\n", __FILE__, __LINE__, __func__,
+          (unsigned long long) shared->segment->period, (unsigned long long) shared->period);
+    }
+    return -1;
+  }
+
+  char data = 0;
+  char control[CMSG_SPACE(sizeof(int))] = {};
+  struct iovec iov = { .iov_base = &data, .iov_len = sizeof(data) };
+  struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1, .msg_control = control, .msg_controllen = sizeof(control) };
+  struct cmsghdr * cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &shared->efd, sizeof(int));
+
+  if (sendmsg(shared->sock, &msg, MSG_NOSIGNAL) < 0) {
+    PRINT_ERROR_ERRNO("sendmsg");
+    return -1;
+  }
+
+  shared->last = __atomic_load_n(&shared->segment->seq, __ATOMIC_ACQUIRE);
+
+  GPOLL_CALLBACKS gpoll_callbacks = {
+          .fp_read = owner_read_callback,
+          .fp_write = NULL,
+          .fp_close = owner_close_callback,
+  };
+  if (shared->fp_register(shared->sock, shared, &gpoll_callbacks) < 0) {
+    return -1;
+  }
+
+  shared->registered = 1;
+
+  return 0;
+}
+
+/*
+ * Try to become the owner of the tick source, or to subscribe to it if it already has an owner.
+ * Returns 0 on success, 1 if the attempt has to be repeated, or -1 in case of error.
+ */
+static int try_elect(struct gshared * shared) {
+
+  shared->sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (shared->sock < 0) {
+    PRINT_ERROR_ERRNO("socket");
+    return -1;
+  }
+
+  if (connect(shared->sock, (struct sockaddr *) &shared->addr, shared->len) == 0) {
+    if (subscribe(shared) < 0) {
+      leave(shared);
+      return -1;
+    }
+  } else if (errno == ECONNREFUSED) {
+    if (bind(shared->sock, (struct sockaddr *) &shared->addr, shared->len) < 0) {
+      if (errno != EADDRINUSE) {
+        PRINT_ERROR_ERRNO("bind");
+        leave(shared);
+        return -1;
+      }
+      close(shared->sock);
+      shared->sock = -1;
+      return 1;
+    }
+    if (become_owner(shared) < 0) {
+      leave(shared);
+      return -1;
+    }
+  } else {
+    if (errno != EAGAIN) {
+      PRINT_ERROR_ERRNO("connect");
+      leave(shared);
+      return -1;
+    }
+    // the backlog of the owner is full
+    close(shared->sock);
+    shared->sock = -1;
+    return 1;
+  }
+
+  shared->read_time = gtime_gettime();
+
+  if (GLOG_LEVEL(GLOG_NAME,DEBUG)) {
+    printf("shared tick source %s: %s\n", shared->shm_name, shared->role == GSHARED_OWNER ? "owner" : "subscriber");
+  }
+
+  return 0;
+}
+
+static void stop_retry(struct gshared * shared) {
+
+  if (shared->retry != NULL) {
+    shared->fp_remove(shared->backend->get_fd(shared->retry));
+    shared->backend->close(shared->retry);
+    shared->retry = NULL;
+  }
+}
+
+static int retry_read_callback(void * user) {
+
+  struct gshared * shared = (struct gshared *) user;
+
+  uint64_t nexp;
+  if (shared->backend->read(shared->retry, &nexp) < 0) {
+    stop_retry(shared);
+    return shared->fp_close(shared->user);
+  }
+
+  if (nexp == 0) {
+    return 0;
+  }
+
+  int ret = try_elect(shared);
+  if (ret == 1 && ++shared->attempts < ELECTION_ATTEMPTS) {
+    return 0;
+  }
+
+  stop_retry(shared);
+
+  if (ret != 0) {
+    if (ret == 1) {
+      PRINT_ERROR_OTHER("cannot join the shared tick source");
+    }
+    return shared->fp_close(shared->user);
+  }
+
+  return 0;
+}
+
+/*
+ * Become the owner of the tick source, or subscribe to it if it already has an owner.
+ * If the owner is not ready yet, or is leaving, the election is repeated from a timer,
+ * so that the event loop is not blocked, and fp_close is called if it fails.
+ */
+static int elect(struct gshared * shared) {
+
+  int ret = try_elect(shared);
+  if (ret != 1) {
+    return ret;
+  }
+
+  shared->attempts = 1;
+
+  shared->retry = shared->backend->open();
+  if (shared->retry == NULL) {
+    return -1;
+  }
+
+  GPOLL_CALLBACKS retry_callbacks = {
+          .fp_read = retry_read_callback,
+          .fp_write = NULL,
+          .fp_close = close_callback,
+  };
+  if (shared->backend->settime(shared->retry, gtime_gettime() + ELECTION_DELAY, ELECTION_DELAY) < 0
+      || shared->fp_register(shared->backend->get_fd(shared->retry), shared, &retry_callbacks) < 0) {
+    shared->backend->close(shared->retry);
+    shared->retry = NULL;
+    return -1;
+  }
+
+  return 0;
+}
+
+/*
+ * Give up the role of the timer, but keep its eventfd.
+ */
+static void leave(struct gshared * shared) {
+
+  stop_retry(shared);
+
+  if (shared->role == GSHARED_OWNER) {
+    // the segment is removed before the socket is released, so that it is never removed by a previous owner
+    shm_unlink(shared->shm_name);
+    if (shared->source != NULL) {
+      shared->fp_remove(shared->backend->get_fd(shared->source));
+      shared->backend->close(shared->source);
+      shared->source = NULL;
+    }
+    while (shared->nb_subscribers > 0) {
+      subscriber_remove(shared->subscribers[0]);
+    }
+    free(shared->subscribers);
+    shared->subscribers = NULL;
+  }
+
+  if (shared->sock >= 0) {
+    if (shared->registered) {
+      shared->fp_remove(shared->sock);
+      shared->registered = 0;
+    }
+    close(shared->sock);
+    shared->sock = -1;
+  }
+
+  if (shared->segment != NULL) {
+    munmap(shared->segment, sizeof(*shared->segment));
+    shared->segment = NULL;
+  }
+
+  shared->role = 0;
+}
+
+struct gshared * gshared_open(const char * name, gtime period, void * user, const GTIMER_CALLBACKS * callbacks) {
+
+  if (strchr(name, '/') != NULL) {
+    PRINT_ERROR_OTHER("shared tick source name cannot contain '/'");
+    return NULL;
+  }
+
+  struct gshared * shared = calloc(1, sizeof(*shared));
+  if (shared == NULL) {
+    PRINT_ERROR_ALLOC_FAILED("calloc");
+    return NULL;
+  }
+
+  shared->addr.sun_family = AF_UNIX;
+
+  // abstract socket, released when the owner exits
+  int size = snprintf(shared->addr.sun_path + 1, sizeof(shared->addr.sun_path) - 1, "gtimer-%u-%s", geteuid(), name);
+  int shm_size = snprintf(shared->shm_name, sizeof(shared->shm_name), "/gtimer-%u-%s", geteuid(), name);
+  if (size < 0 || (size_t) size >= sizeof(shared->addr.sun_path) - 1
+      || shm_size < 0 || (size_t) shm_size >= sizeof(shared->shm_name)) {
+    PRINT_ERROR_OTHER("shared tick source name is too long");
+    free(shared);
+    return NULL;
+  }
+
+  shared->len = offsetof(struct sockaddr_un, sun_path) + 1 + size;
+  shared->period = period;
+  shared->sock = -1;
+  shared->user = user;
+  shared->fp_close = callbacks->fp_close;
+  shared->fp_register = callbacks->fp_register;
+  shared->fp_remove = callbacks->fp_remove;
+  shared->backend = gbackend_get();
+
+  shared->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (shared->efd < 0) {
+    PRINT_ERROR_ERRNO("eventfd");
+    free(shared);
+    return NULL;
+  }
+
+  if (elect(shared) < 0) {
+    gshared_close(shared);
+    return NULL;
+  }
+
+  return shared;
+}
+
+void gshared_close(struct gshared * shared) {
+
+  leave(shared);
+
+  close(shared->efd);
+  free(shared);
+}
+
+static int shared_get_fd(void * user) {
+
+  struct gshared * shared = (struct gshared *) user;
+
+  return shared->efd;
+}
+
+static int shared_settime(void * user __attribute__((unused)), gtime value __attribute__((unused)),
+    gtime interval __attribute__((unused))) {
+
+  // the period is set by the owner
+  return 0;
+}
+
+static int shared_read(void * user, uint64_t * nexp) {
+
+  struct gshared * shared = (struct gshared *) user;
+
+  uint64_t value;
+  if (read(shared->efd, &value, sizeof(value)) < 0) {
+    if (errno != EAGAIN) {
+      PRINT_ERROR_ERRNO("read");
+      return -1;
+    }
+  }
+
+  *nexp = 0;
+
+  if (shared->segment == NULL) {
+    // no owner could be elected
+    return 0;
+  }
+
+  uint64_t seq = __atomic_load_n(&shared->segment->seq, __ATOMIC_ACQUIRE);
+  gtime now = gtime_gettime();
+
+  if (seq == shared->last) {
+    return 0;
+  }
+
+  // the tick count cannot increase faster than time
+  uint64_t max = (now - shared->read_time) / shared->period + 1;
+
+  if (seq < shared->last) {
+    *nexp = 1;
+  } else {
+    *nexp = seq - shared->last;
+    if (*nexp > max) {
+      *nexp = max;
+    }
+  }
+
+  shared->last = seq;
+  shared->read_time = now;
+
+  return 0;
+}
+
+static void shared_close(void * user) {
+
+  gshared_close((struct gshared *) user);
+}
+
+const GTIMER_BACKEND gbackend_shared = {
+    .name = "shared",
+    .open = NULL,
+    .get_fd = shared_get_fd,
+    .settime = shared_settime,
+    .read = shared_read,
+    .close = shared_close,
+};
@@ -0,0 +1,27 @@
+/*
+ Copyright (c) 2026 Mathieu Laurendeau <mat.lau@laposte.net>
+ License: GPLv3
+ */
+
+#ifndef GSHARED_H_
+#define GSHARED_H_
+
+#include <gtimer.h>
+#include "gbackend.h"
+
+struct gshared;
+
+/*
+ * Join the named tick source, as its owner if it has none.
+ * The returned object is a source of gbackend_shared.
+ */
+struct gshared * gshared_open(const char * name, gtime period, void * user, const GTIMER_CALLBACKS * callbacks);
+
+void gshared_close(struct gshared * shared);
+
+/*
+ * The timer source of shared timers, it cannot be set.
+ */
+extern const GTIMER_BACKEND gbackend_shared;
+
+#endif /* GSHARED_H_ */
@@ -0,0 +1,187 @@
+/*
+ Copyright (c) 2026 Mathieu Laurendeau <mat.lau@laposte.net>
+ License: GPLv3
+ */
+
+#include "gstats.h"
+#include <gimxcommon/include/gerror.h>
+#include <gimxlog/include/glog.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+GLOG_GET(GLOG_NAME)
+
+static char * segment_name = NULL;
+static struct gtimer_stats * segment = NULL;
+static ino_t segment_ino = 0;
+
+/*
+ * Take over a statistics segment left by a process that exited without closing it.
+ * The pid is swapped atomically, so that a single process can take it over.
+ * Segments that are not statistics segments are considered in use, so that they are never overwritten.
+ */
+static int take_over(const char * name) {
+
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    int taken = 0;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (size_t) st.st_size >= sizeof(*segment)) {
+        struct gtimer_stats * existing = mmap(NULL, sizeof(*existing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (existing != MAP_FAILED) {
+            uint32_t pid = __atomic_load_n(&existing->pid, __ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&existing->magic, __ATOMIC_ACQUIRE) == GTIMER_STATS_MAGIC
+                && kill(pid, 0) < 0 && errno == ESRCH) {
+                taken = __atomic_compare_exchange_n(&existing->pid, &pid, getpid(), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+            }
+            munmap(existing, sizeof(*existing));
+        }
+    }
+
+    if (!taken) {
+        if (GLOG_LEVEL(GLOG_NAME,ERROR)) {
+            fprintf(stderr, "%s:%d %s: shared-memory segment %s is in use\n", __FILE__, __LINE__, __func__, name);
+        }
+        close(fd);
+        errno = EEXIST;
+        return -1;
+    }
+
+    return fd;
+}
+
+static int create_segment(const char * name) {
+
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST) {
+        // the segment is reused rather than unlinked and created again, as another process may do the same
+        fd = take_over(name);
+    }
+
+    return fd;
+}
+
+int gstats_open(const char * name) {
+
+    if (segment != NULL) {
+        PRINT_ERROR_OTHER("statistics are already exported");
+        return -1;
+    }
+
+    int fd = create_segment(name);
+    if (fd < 0) {
+        if (errno != EEXIST) {
+            PRINT_ERROR_ERRNO("shm_open");
+        }
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        PRINT_ERROR_ERRNO("fstat");
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+    segment_ino = st.st_ino;
+
+    if (ftruncate(fd, sizeof(*segment)) < 0) {
+        PRINT_ERROR_ERRNO("ftruncate");
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+
+    void * ptr = mmap(NULL, sizeof(*segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        PRINT_ERROR_ERRNO("mmap");
+        shm_unlink(name);
+        return -1;
+    }
+
+    segment_name = strdup(name);
+    if (segment_name == NULL) {
+        PRINT_ERROR_ALLOC_FAILED("strdup");
+        munmap(ptr, sizeof(*segment));
+        shm_unlink(name);
+        return -1;
+    }
+
+    segment = ptr;
+
+    memset(segment, 0x00, sizeof(*segment));
+    segment->version = GTIMER_STATS_VERSION;
+    segment->pid = getpid();
+    segment->max_timers = GTIMER_STATS_MAX_TIMERS;
+    // publish the magic last, readers ignore the segment until it is set
+    __atomic_store_n(&segment->magic, GTIMER_STATS_MAGIC, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+void gstats_close() {
+
+    if (segment == NULL) {
+        return;
+    }
+
+    munmap(segment, sizeof(*segment));
+    segment = NULL;
+
+    // do not remove a segment that replaced ours
+    int fd = shm_open(segment_name, O_RDONLY, 0);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_ino == segment_ino) {
+            shm_unlink(segment_name);
+        }
+        close(fd);
+    }
+    free(segment_name);
+    segment_name = NULL;
+}
+
+struct gtimer_stats_timer * gstats_alloc(gtime period) {
+
+    if (segment == NULL) {
+        return NULL;
+    }
+
+    unsigned int i;
+    for (i = 0; i < GTIMER_STATS_MAX_TIMERS; ++i) {
+        struct gtimer_stats_timer * slot = segment->timers + i;
+        if (slot->active == 0) {
+            gstats_write_begin(slot);
+            memset((char *) slot + sizeof(slot->seq), 0x00, sizeof(*slot) - sizeof(slot->seq));
+            slot->active = 1;
+            slot->period = period;
+            gstats_write_end(slot);
+            return slot;
+        }
+    }
+
+    if (GLOG_LEVEL(GLOG_NAME,INFO)) {
+        printf("no statistics slot left, timer will not be monitored\n");
+    }
+
+    return NULL;
+}
+
+void gstats_free(struct gtimer_stats_timer * slot) {
+
+    gstats_write_begin(slot);
+    slot->active = 0;
+    gstats_write_end(slot);
+}
@@ -0,0 +1,52 @@
+/*
+ Copyright (c) 2026 Mathieu Laurendeau <mat.lau@laposte.net>
+ License: GPLv3
+ */
+
+#ifndef GSTATS_H_
+#define GSTATS_H_
+
+#include <gtimer_stats.h>
+#include <gimxtime/include/gtime.h>
+
+int gstats_open(const char * name);
+void gstats_close();
+
+struct gtimer_stats_timer * gstats_alloc(gtime period);
+void gstats_free(struct gtimer_stats_timer * slot);
+
+static inline void gstats_write_begin(struct gtimer_stats_timer * slot) {
+
+    __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void gstats_write_end(struct gtimer_stats_timer * slot) {
+
+    __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELEASE);
+}
+
+static inline void gstats_update(struct gtimer_stats_timer * slot, uint64_t nexp, gtimediff lateness, gtime cbtime) {
+
+    unsigned int bucket = 0;
+    if (lateness >= 1000) {
+        bucket = 64 - __builtin_clzll(lateness / 1000);
+        if (bucket > GTIMER_STATS_LATENESS_BUCKETS - 1) {
+            bucket = GTIMER_STATS_LATENESS_BUCKETS - 1;
+        }
+    }
+
+    gstats_write_begin(slot);
+
+    ++slot->count;
+    slot->missed += nexp - 1;
+    ++slot->lateness[bucket];
+    slot->cb_total += cbtime;
+    if (cbtime > slot->cb_max) {
+        slot->cb_max = cbtime;
+    }
+
+    gstats_write_end(slot);
+}
+
+#endif /* GSTATS_H_ */
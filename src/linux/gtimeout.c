@@ -0,0 +1,354 @@
+/*
+ Copyright (c) 2026 Mathieu Laurendeau <mat.lau@laposte.net>
+ License: GPLv3
+ */
+
+#include <gtimer.h>
+#include "gbackend.h"
+#include <gimxcommon/include/gerror.h>
+#include <gimxcommon/include/glist.h>
+#include <gimxlog/include/glog.h>
+#include <gimxtime/include/gtime.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+GLOG_GET(GLOG_NAME)
+
+/*
+ * All timeouts share a single timer source, armed at the earliest deadline of a binary min-heap.
+ *
+ * Resetting a timeout only updates its expiry. The heap entry keeps its previous deadline,
+ * and is moved when that deadline is reached. As a timeout can only be pushed back,
+ * the timer source never needs to be re-armed on a reset.
+ */
+
+struct gtimeout {
+  void * user;
+  GPOLL_READ_CALLBACK fp_read;
+  GPOLL_CLOSE_CALLBACK fp_close;
+  gtime duration;
+  gtime expiry; // latest expiry time
+  gtime key; // deadline used for the heap ordering, lower or equal to expiry
+  int index; // position in the heap, -1 if the timeout is expired
+  unsigned int closing; // last source failure that was reported
+  GLIST_LINK(struct gtimeout);
+};
+
+// all timeouts, expired or not
+static GLIST_INST(struct gtimeout, all);
+
+static struct {
+  const GTIMER_BACKEND * backend;
+  void * source;
+  int fd;
+  GTIMER_REMOVE_SOURCE fp_remove;
+  unsigned int nb_users;
+  gtime armed; // 0 if disarmed
+  unsigned int closing; // number of source failures
+  struct gtimeout ** heap;
+  unsigned int size;
+  unsigned int capacity;
+} timeouts = { .fd = -1 };
+
+static int arm(gtime deadline) {
+
+  if (deadline == timeouts.armed) {
+    return 0;
+  }
+
+  if (timeouts.backend->settime(timeouts.source, deadline, 0) < 0) {
+    return -1;
+  }
+
+  timeouts.armed = deadline;
+
+  return 0;
+}
+
+static inline void heap_set(unsigned int index, struct gtimeout * timeout) {
+
+  timeouts.heap[index] = timeout;
+  timeout->index = index;
+}
+
+static void sift_up(unsigned int index) {
+
+  struct gtimeout * timeout = timeouts.heap[index];
+
+  while (index > 0) {
+    unsigned int parent = (index - 1) / 2;
+    if (timeouts.heap[parent]->key <= timeout->key) {
+      break;
+    }
+    heap_set(index, timeouts.heap[parent]);
+    index = parent;
+  }
+
+  heap_set(index, timeout);
+}
+
+static void sift_down(unsigned int index) {
+
+  struct gtimeout * timeout = timeouts.heap[index];
+
+  for (;;) {
+    unsigned int child = 2 * index + 1;
+    if (child >= timeouts.size) {
+      break;
+    }
+    if (child + 1 < timeouts.size && timeouts.heap[child + 1]->key < timeouts.heap[child]->key) {
+      ++child;
+    }
+    if (timeout->key <= timeouts.heap[child]->key) {
+      break;
+    }
+    heap_set(index, timeouts.heap[child]);
+    index = child;
+  }
+
+  heap_set(index, timeout);
+}
+
+static void heap_push(struct gtimeout * timeout) {
+
+  timeout->key = timeout->expiry;
+  heap_set(timeouts.size++, timeout);
+  sift_up(timeout->index);
+}
+
+static void heap_remove(struct gtimeout * timeout) {
+
+  unsigned int index = timeout->index;
+
+  timeout->index = -1;
+
+  struct gtimeout * last = timeouts.heap[--timeouts.size];
+  if (last == timeout) {
+    return;
+  }
+
+  heap_set(index, last);
+  sift_down(index);
+  sift_up(last->index);
+}
+
+static int close_callback(void * user __attribute__((unused))) {
+
+  int ret = 0;
+
+  unsigned int closing = ++timeouts.closing;
+
+  // fp_close may close any timeout, so the walk restarts after each call
+  struct gtimeout * timeout = GLIST_BEGIN(all);
+  while (timeout != GLIST_END(all)) {
+    if (timeout->closing == closing) {
+      timeout = timeout->next;
+      continue;
+    }
+    timeout->closing = closing;
+    if (timeout->fp_close(timeout->user) < 0) {
+      ret = -1;
+    }
+    timeout = GLIST_BEGIN(all);
+  }
+
+  return ret;
+}
+
+static int read_callback(void * user __attribute__((unused))) {
+
+  uint64_t nexp;
+
+  if (timeouts.backend->read(timeouts.source, &nexp) < 0) {
+    return -1;
+  }
+
+  if (nexp == 0) {
+    return 0;
+  }
+
+  timeouts.armed = 0;
+
+  int ret = 0;
+
+  gtime now = gtime_gettime();
+
+  // callbacks may reset or close any timeout, so the top of the heap is read again at each iteration
+  while (timeouts.size > 0 && timeouts.heap[0]->key <= now) {
+
+    struct gtimeout * timeout = timeouts.heap[0];
+
+    if (timeout->expiry > now) {
+      // the timeout was reset since it was queued: move it to its current expiry
+      timeout->key = timeout->expiry;
+      sift_down(0);
+      continue;
+    }
+
+    heap_remove(timeout);
+
+    int status = timeout->fp_read(timeout->user);
+    if (status < 0) {
+      ret = -1;
+    } else if (ret != -1 && status) {
+      ret = 1;
+    }
+  }
+
+  if (timeouts.size > 0 && arm(timeouts.heap[0]->key) < 0) {
+    return -1;
+  }
+
+  return ret;
+}
+
+static int begin(const GTIMER_CALLBACKS * callbacks) {
+
+  if (timeouts.nb_users > 0) {
+    return 0;
+  }
+
+  const GTIMER_BACKEND * backend = gbackend_get();
+  void * source = backend->open();
+  if (source == NULL) {
+    return -1;
+  }
+
+  int fd = backend->get_fd(source);
+
+  GPOLL_CALLBACKS gpoll_callbacks = {
+          .fp_read = read_callback,
+          .fp_write = NULL,
+          .fp_close = close_callback,
+  };
+  if (callbacks->fp_register(fd, NULL, &gpoll_callbacks) < 0) {
+    backend->close(source);
+    return -1;
+  }
+
+  timeouts.backend = backend;
+  timeouts.source = source;
+  timeouts.fd = fd;
+  timeouts.fp_remove = callbacks->fp_remove;
+  timeouts.armed = 0;
+
+  return 0;
+}
+
+static void end() {
+
+  if (timeouts.nb_users > 0) {
+    return;
+  }
+
+  timeouts.fp_remove(timeouts.fd);
+  timeouts.backend->close(timeouts.source);
+  timeouts.source = NULL;
+  timeouts.fd = -1;
+
+  free(timeouts.heap);
+  timeouts.heap = NULL;
+  timeouts.capacity = 0;
+}
+
+struct gtimeout * gtimeout_start(void * user, unsigned int usec, const GTIMER_CALLBACKS * callbacks) {
+
+  if (usec == 0) {
+    PRINT_ERROR_OTHER("timeout cannot be 0");
+    return NULL;
+  }
+
+  if (callbacks->fp_read == NULL) {
+    PRINT_ERROR_OTHER("fp_read is NULL");
+    return NULL;
+  }
+
+  if (callbacks->fp_register == NULL) {
+    PRINT_ERROR_OTHER("fp_register is NULL");
+    return NULL;
+  }
+
+  if (callbacks->fp_remove == NULL) {
+    PRINT_ERROR_OTHER("fp_remove is NULL");
+    return NULL;
+  }
+
+  // reserve a heap entry for each timeout, so that resets never allocate
+  if (timeouts.nb_users == timeouts.capacity) {
+    unsigned int capacity = timeouts.capacity ? timeouts.capacity * 2 : 16;
+    void * ptr = realloc(timeouts.heap, capacity * sizeof(*timeouts.heap));
+    if (ptr == NULL) {
+      PRINT_ERROR_ALLOC_FAILED("realloc");
+      return NULL;
+    }
+    timeouts.heap = ptr;
+    timeouts.capacity = capacity;
+  }
+
+  struct gtimeout * timeout = calloc(1, sizeof(*timeout));
+  if (timeout == NULL) {
+    PRINT_ERROR_ALLOC_FAILED("calloc");
+    return NULL;
+  }
+
+  if (begin(callbacks) < 0) {
+    free(timeout);
+    return NULL;
+  }
+
+  ++timeouts.nb_users;
+
+  timeout->user = user;
+  timeout->fp_read = callbacks->fp_read;
+  timeout->fp_close = callbacks->fp_close;
+  timeout->duration = usec * 1000ULL;
+  timeout->expiry = gtime_gettime() + timeout->duration;
+
+  heap_push(timeout);
+
+  timeout->closing = timeouts.closing;
+  GLIST_ADD(all, timeout);
+
+  if (timeouts.heap[0] == timeout && arm(timeout->key) < 0) {
+    gtimeout_close(timeout);
+    return NULL;
+  }
+
+  return timeout;
+}
+
+int gtimeout_reset(struct gtimeout * timeout) {
+
+  timeout->expiry = gtime_gettime() + timeout->duration;
+
+  if (timeout->index >= 0) {
+    return 0;
+  }
+
+  // the timeout already expired, queue it again
+  heap_push(timeout);
+
+  if (timeouts.heap[0] == timeout && (timeouts.armed == 0 || timeout->key < timeouts.armed)) {
+    return arm(timeout->key);
+  }
+
+  return 0;
+}
+
+int gtimeout_close(struct gtimeout * timeout) {
+
+  if (timeout->index >= 0) {
+    heap_remove(timeout);
+  }
+
+  GLIST_REMOVE(all, timeout);
+
+  free(timeout);
+
+  --timeouts.nb_users;
+
+  end();
+
+  return 1;
+}
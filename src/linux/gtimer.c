@@ -4,11 +4,13 @@
  */
 
 #include <gtimer.h>
+#include "gstats.h"
+#include "gbackend.h"
+#include "gshared.h"
 #include <gimxcommon/include/gerror.h>
 #include <gimxcommon/include/glist.h>
 #include <gimxlog/include/glog.h>
 #include <gimxtime/include/gtime.h>
-#include <sys/timerfd.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <stdint.h>
@@ -19,11 +21,39 @@
 GLOG_INST(GLOG_NAME)
 
 struct gtimer {
+  const GTIMER_BACKEND * backend;
+  void * source;
   int fd;
   void * user;
   GPOLL_READ_CALLBACK fp_read;
+  GTIMER_BATCH_CALLBACK fp_batch;
   GPOLL_CLOSE_CALLBACK fp_close;
   GTIMER_REMOVE_SOURCE fp_remove;
+  gtime period; // kernel timer period
+  gtime tick; // logical tick period
+  unsigned int ratio; // logical ticks per kernel timer expiration
+  gtime deadline; // last logical tick
+  struct {
+      uint64_t rem; // the period is period + rem / den nanoseconds
+      uint64_t den;
+      uint64_t acc; // accumulated fractional nanoseconds, in 1/den nanoseconds
+      gtime interval; // kernel timer interval
+      gtime expiration; // last kernel timer expiration
+  } exact;
+  struct gtimer_stats_timer * stats;
+  struct {
+      int enabled;
+      double kp; // phase gain
+      double ki; // frequency gain
+      gtimediff offset;
+      gtime threshold;
+      gtime nominal;
+      double period; // current period estimate, in nanoseconds
+      gtime anchor; // a tick of the current schedule
+      gtime last; // last external event
+      gtimediff error; // last phase error
+      unsigned int in_lock; // number of consecutive events within the lock threshold
+  } pll;
   GLIST_LINK(struct gtimer);
   struct {
       unsigned int count;
@@ -34,6 +64,16 @@ struct gtimer {
 
 static GLIST_INST(struct gtimer, timers);
 
+static int stats_enabled = 0;
+
+// loop gains are derived from the bandwidth for a damping factor of sqrt(2)/2,
+// the loop is unstable above a bandwidth of about 0.15 events
+#define PLL_MAX_BANDWIDTH 0.1
+// maximum deviation from the nominal period, in percents
+#define PLL_MAX_DEVIATION 10
+// number of consecutive events within the threshold to be considered locked
+#define PLL_LOCK_COUNT 8
+
 static int close_callback(void * user) {
 
   struct gtimer * timer = (struct gtimer *) user;
@@ -41,19 +81,100 @@ static int close_callback(void * user) {
   return timer->fp_close(timer->user);
 }
 
+static inline long long int round_nearest(double value) {
+
+  return value < 0 ? (long long int) (value - 0.5) : (long long int) (value + 0.5);
+}
+
+static inline int arm(struct gtimer * timer, gtime value, gtime interval) {
+
+  return timer->backend->settime(timer->source, value, interval);
+}
+
+/*
+ * Update the last deadline after nexp periods, distributing the fractional part of the period.
+ */
+static inline void advance(struct gtimer * timer, uint64_t nexp) {
+
+  timer->deadline += nexp * timer->period;
+
+  if (timer->exact.rem) {
+    uint64_t acc = timer->exact.acc + nexp * timer->exact.rem;
+    timer->deadline += acc / timer->exact.den;
+    timer->exact.acc = acc % timer->exact.den;
+  }
+}
+
+/*
+ * Re-arm the kernel timer when its next expiration would be more than 1ns away from the next exact deadline.
+ *
+ * As the kernel interval is rounded, the kernel schedule drifts from the exact one by less than 0.5ns per period.
+ * When it is re-armed, it starts as far as possible on the side it drifts away from, to re-arm as rarely as possible.
+ */
+static int realign(struct gtimer * timer, uint64_t nexp) {
+
+  timer->exact.expiration += nexp * timer->exact.interval;
+
+  // the next exact deadline is next + frac / den nanoseconds
+  uint64_t sum = timer->exact.acc + timer->exact.rem;
+  gtime next = timer->deadline + timer->period + sum / timer->exact.den;
+  uint64_t frac = sum % timer->exact.den;
+
+  gtime expiration = timer->exact.expiration + timer->exact.interval;
+
+  if (expiration == next || expiration == next + 1 || (frac == 0 && expiration + 1 == next)) {
+    return 0;
+  }
+
+  if (timer->exact.interval == timer->period) {
+    // the interval was rounded down, the schedule drifts earlier
+    ++next;
+  } else if (frac == 0) {
+    // the interval was rounded up, the schedule drifts later
+    --next;
+  }
+
+  timer->exact.expiration = next - timer->exact.interval;
+
+  return arm(timer, next, timer->exact.interval);
+}
+
+static int fire(struct gtimer * timer, gtime first, uint64_t nexp) {
+
+  if (timer->fp_batch != NULL) {
+    return timer->fp_batch(timer->user, first, timer->tick, nexp * timer->ratio);
+  }
+
+  // the ticks of a wakeup are delivered in a burst, missed wakeups are coalesced
+  int ret = 0;
+
+  unsigned int i;
+  for (i = 0; i < timer->ratio; ++i) {
+    int status = timer->fp_read(timer->user);
+    if (status < 0) {
+      return -1;
+    } else if (status) {
+      ret = 1;
+    }
+  }
+
+  return ret;
+}
+
 static int read_callback(void * user) {
 
   struct gtimer * timer = (struct gtimer *) user;
 
   uint64_t nexp;
-  ssize_t res;
 
-  res = read(timer->fd, &nexp, sizeof(nexp));
-  if (res != sizeof(nexp)) {
-    PRINT_ERROR_ERRNO("read");
+  if (timer->backend->read(timer->source, &nexp) < 0) {
     return -1;
   }
 
+  if (nexp == 0) {
+    return 0;
+  }
+
   if (GLOG_LEVEL(GLOG_NAME,DEBUG)) {
 
     ++(timer->debug.count);
@@ -68,82 +189,380 @@ static int read_callback(void * user) {
     }
   }
 
-  return timer->fp_read(timer->user);
+  gtime first = timer->deadline + timer->tick;
+
+  advance(timer, nexp);
+
+  if (timer->exact.rem && realign(timer, nexp) < 0) {
+    return -1;
+  }
+
+  if (timer->stats == NULL) {
+    return fire(timer, first, nexp);
+  }
+
+  gtime now = gtime_gettime();
+
+  int ret = fire(timer, first, nexp);
+
+  gstats_update(timer->stats, nexp, now - timer->deadline, gtime_gettime() - now);
+
+  return ret;
 }
 
-struct gtimer * gtimer_start(void * user, unsigned int usec, const GTIMER_CALLBACKS * callbacks) {
+static int check_callbacks(GTIMER_BATCH_CALLBACK fp_batch, const GTIMER_CALLBACKS * callbacks) {
 
-  __time_t sec = usec / 1000000;
-  __time_t nsec = (usec - sec * 1000000) * 1000;
-  struct timespec period = { .tv_sec = sec, .tv_nsec = nsec };
-  struct itimerspec new_value = { .it_interval = period, .it_value = period, };
+  if (fp_batch == NULL && callbacks->fp_read == NULL)
+  {
+    PRINT_ERROR_OTHER("fp_read is NULL");
+    return -1;
+  }
 
   if (callbacks->fp_register == NULL)
   {
     PRINT_ERROR_OTHER("fp_register is NULL");
-    return NULL;
+    return -1;
   }
 
   if (callbacks->fp_remove == NULL)
   {
     PRINT_ERROR_OTHER("fp_remove is NULL");
-    return NULL;
+    return -1;
   }
 
-  int tfd = timerfd_create(CLOCK_MONOTONIC, 0);
-  if (tfd < 0) {
-    PRINT_ERROR_ERRNO("timerfd_create");
-    return NULL;
-  }
+  return 0;
+}
 
-  int ret = timerfd_settime(tfd, 0, &new_value, NULL);
-  if (ret) {
-    PRINT_ERROR_ERRNO("timerfd_settime");
-    close(tfd);
-    return NULL;
-  }
+/*
+ * Start a timer on an open source, the source is closed in case of failure.
+ */
+static struct gtimer * start_source(void * user, const GTIMER_BACKEND * backend, void * source, gtime tick, unsigned int ratio,
+    GTIMER_BATCH_CALLBACK fp_batch, const GTIMER_CALLBACKS * callbacks) {
 
   struct gtimer * timer = calloc(1, sizeof(*timer));
   if (timer == NULL) {
     PRINT_ERROR_ALLOC_FAILED("calloc");
+    backend->close(source);
+    return NULL;
+  }
+
+  timer->backend = backend;
+  timer->source = source;
+
+  // use an absolute start time so that tick timestamps are exact
+  gtime period = tick * ratio;
+  gtime start = gtime_gettime();
+
+  int ret = arm(timer, start + period, period);
+  if (ret < 0) {
+    timer->backend->close(timer->source);
+    free(timer);
     return NULL;
   }
 
+  timer->fd = timer->backend->get_fd(timer->source);
+
   GPOLL_CALLBACKS gpoll_callbacks = {
           .fp_read = read_callback,
           .fp_write = NULL,
           .fp_close = close_callback,
   };
-  ret = callbacks->fp_register(tfd, timer, &gpoll_callbacks);
+  ret = callbacks->fp_register(timer->fd, timer, &gpoll_callbacks);
   if (ret < 0) {
-    close(tfd);
+    timer->backend->close(timer->source);
     free(timer);
     return NULL;
   }
 
-  timer->fd = tfd;
   timer->user = user;
   timer->fp_read = callbacks->fp_read;
+  timer->fp_batch = fp_batch;
   timer->fp_close = callbacks->fp_close;
   timer->fp_remove = callbacks->fp_remove;
+  timer->period = period;
+  timer->tick = tick;
+  timer->ratio = ratio;
+  timer->deadline = start;
+
+  if (stats_enabled) {
+    timer->stats = gstats_alloc(timer->period);
+  }
 
   GLIST_ADD(timers, timer);
 
   return timer;
 }
 
+static struct gtimer * start_timer(void * user, gtime tick, unsigned int ratio, GTIMER_BATCH_CALLBACK fp_batch,
+    const GTIMER_CALLBACKS * callbacks) {
+
+  if (tick == 0 || ratio == 0) {
+    PRINT_ERROR_OTHER("timer period cannot be 0");
+    return NULL;
+  }
+
+  if (check_callbacks(fp_batch, callbacks) < 0) {
+    return NULL;
+  }
+
+  const GTIMER_BACKEND * backend = gbackend_get();
+  void * source = backend->open();
+  if (source == NULL) {
+    return NULL;
+  }
+
+  return start_source(user, backend, source, tick, ratio, fp_batch, callbacks);
+}
+
+struct gtimer * gtimer_start(void * user, unsigned int usec, const GTIMER_CALLBACKS * callbacks) {
+
+  return start_timer(user, usec * 1000ULL, 1, NULL, callbacks);
+}
+
+struct gtimer * gtimer_start_ns(void * user, uint64_t nsec, const GTIMER_CALLBACKS * callbacks) {
+
+  return start_timer(user, nsec, 1, NULL, callbacks);
+}
+
+static uint64_t gcd(uint64_t a, uint64_t b) {
+
+  while (b) {
+    uint64_t r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+struct gtimer * gtimer_start_rational(void * user, uint64_t num, uint64_t den, const GTIMER_CALLBACKS * callbacks) {
+
+  if (den == 0 || den > UINT32_MAX) {
+    PRINT_ERROR_OTHER("invalid period denominator");
+    return NULL;
+  }
+
+  unsigned __int128 total = (unsigned __int128) num * 1000000000;
+  if (total / den > UINT64_MAX) {
+    PRINT_ERROR_OTHER("timer period is too long");
+    return NULL;
+  }
+
+  uint64_t period = total / den;
+  uint64_t rem = total % den;
+
+  struct gtimer * timer = start_timer(user, period, 1, NULL, callbacks);
+  if (timer == NULL || rem == 0) {
+    return timer;
+  }
+
+  uint64_t divisor = gcd(rem, den);
+
+  timer->exact.rem = rem / divisor;
+  timer->exact.den = den / divisor;
+
+  // round the kernel interval to the nearest nanosecond, to re-arm as rarely as possible
+  timer->exact.interval = period + (2 * timer->exact.rem >= timer->exact.den);
+  timer->exact.expiration = timer->deadline + period - timer->exact.interval;
+
+  if (timer->exact.interval != period && arm(timer, timer->deadline + period, timer->exact.interval) < 0) {
+    gtimer_close(timer);
+    return NULL;
+  }
+
+  return timer;
+}
+
+struct gtimer * gtimer_start_batched(void * user, gtime nsec, const GTIMER_BATCH * batch, const GTIMER_CALLBACKS * callbacks) {
+
+  return start_timer(user, nsec, batch->ratio, batch->fp_batch, callbacks);
+}
+
+struct gtimer * gtimer_start_shared(void * user, const char * name, unsigned int usec, const GTIMER_CALLBACKS * callbacks) {
+
+  if (usec == 0) {
+    PRINT_ERROR_OTHER("timer period cannot be 0");
+    return NULL;
+  }
+
+  if (check_callbacks(NULL, callbacks) < 0) {
+    return NULL;
+  }
+
+  gtime period = usec * 1000ULL;
+
+  struct gshared * shared = gshared_open(name, period, user, callbacks);
+  if (shared == NULL) {
+    return NULL;
+  }
+
+  return start_source(user, &gbackend_shared, shared, period, 1, NULL, callbacks);
+}
+
 int gtimer_close(struct gtimer * timer) {
 
   timer->fp_remove(timer->fd);
-  close(timer->fd);
+  timer->backend->close(timer->source);
 
   if (GLOG_LEVEL(GLOG_NAME,DEBUG) && timer->debug.count) {
     printf("timer: count = %u, missed = %u (%.02f%%)\n", timer->debug.count, timer->debug.missed, (double)timer->debug.missed * 100 / (timer->debug.count + timer->debug.missed));
   }
 
+  if (timer->stats != NULL) {
+    gstats_free(timer->stats);
+  }
+
   GLIST_REMOVE(timers, timer);
 
   free(timer);
 
   return 1;
 }
+
+struct gtimer * gtimer_start_pll(void * user, unsigned int usec, const GTIMER_PLL * pll, const GTIMER_CALLBACKS * callbacks) {
+
+  if (pll->bandwidth <= 0 || pll->bandwidth > PLL_MAX_BANDWIDTH) {
+    if (GLOG_LEVEL(GLOG_NAME,ERROR)) {
+      fprintf(stderr, "%s:%d %s: loop bandwidth should be in ]0, %.2f]\n", __FILE__, __LINE__, __func__, PLL_MAX_BANDWIDTH);
+    }
+    return NULL;
+  }
+
+  struct gtimer * timer = start_timer(user, usec * 1000ULL, 1, NULL, callbacks);
+  if (timer == NULL) {
+    return NULL;
+  }
+
+  double omega = 2 * 3.14159265358979323846 * pll->bandwidth;
+
+  timer->pll.enabled = 1;
+  timer->pll.kp = 1.41421356237309504880 * omega;
+  timer->pll.ki = omega * omega;
+  timer->pll.offset = pll->offset;
+  timer->pll.threshold = pll->lock_threshold ? pll->lock_threshold : timer->period / 100;
+  timer->pll.nominal = timer->period;
+  timer->pll.period = timer->period;
+  timer->pll.anchor = timer->deadline;
+
+  return timer;
+}
+
+/*
+ * Re-arm the timer according to the current estimates, without delivering the last tick twice.
+ */
+static int pll_rearm(struct gtimer * timer) {
+
+  double period = timer->pll.period;
+  gtime tick = round_nearest(period);
+
+  gtimediff after = timer->deadline + tick / 2 - timer->pll.anchor;
+  long long int ticks = round_nearest((double) after / period + 0.5);
+  gtime next = timer->pll.anchor + round_nearest(ticks * period);
+
+  if (arm(timer, next, tick) < 0) {
+    return -1;
+  }
+
+  timer->period = tick;
+  timer->tick = tick;
+  timer->deadline = next - tick;
+
+  return 0;
+}
+
+int gtimer_pll_event(struct gtimer * timer, gtime timestamp) {
+
+  if (!timer->pll.enabled) {
+    PRINT_ERROR_OTHER("not a phase-locked timer");
+    return -1;
+  }
+
+  double period = timer->pll.period;
+
+  gtime target = timestamp + timer->pll.offset;
+  gtimediff delta = target - timer->pll.anchor;
+  long long int ticks = round_nearest(delta / period);
+  double error = delta - ticks * period;
+
+  if (timer->pll.last == 0) {
+    // acquisition: align the phase at once
+    timer->pll.anchor = target;
+    error = 0;
+  } else {
+    // the frequency error accumulates over the ticks elapsed since the previous event
+    long long int elapsed = round_nearest((timestamp - timer->pll.last) / period);
+    if (elapsed < 1) {
+      elapsed = 1;
+    }
+    period += timer->pll.ki * error / elapsed;
+
+    double deviation = (double) timer->pll.nominal * PLL_MAX_DEVIATION / 100;
+    if (period > timer->pll.nominal + deviation) {
+      period = timer->pll.nominal + deviation;
+    } else if (period < timer->pll.nominal - deviation) {
+      period = timer->pll.nominal - deviation;
+    }
+
+    timer->pll.anchor += round_nearest(ticks * timer->pll.period + timer->pll.kp * error);
+    timer->pll.period = period;
+  }
+
+  timer->pll.last = timestamp;
+  timer->pll.error = round_nearest(error);
+
+  if ((timer->pll.error < 0 ? -timer->pll.error : timer->pll.error) < (gtimediff) timer->pll.threshold) {
+    if (timer->pll.in_lock < PLL_LOCK_COUNT) {
+      ++timer->pll.in_lock;
+    }
+  } else {
+    timer->pll.in_lock = 0;
+  }
+
+  return pll_rearm(timer);
+}
+
+int gtimer_pll_get_status(struct gtimer * timer, GTIMER_PLL_STATUS * status) {
+
+  if (!timer->pll.enabled) {
+    PRINT_ERROR_OTHER("not a phase-locked timer");
+    return -1;
+  }
+
+  status->locked = (timer->pll.in_lock >= PLL_LOCK_COUNT);
+  status->period = round_nearest(timer->pll.period);
+  status->error = timer->pll.error;
+
+  return 0;
+}
+
+int gtimer_set_backend(const char * name) {
+
+  return gbackend_select(name);
+}
+
+int gtimer_stats_open(const char * name) {
+
+  if (gstats_open(name) < 0) {
+    return -1;
+  }
+
+  stats_enabled = 1;
+
+  struct gtimer * timer;
+  for (timer = GLIST_BEGIN(timers); timer != GLIST_END(timers); timer = timer->next) {
+    timer->stats = gstats_alloc(timer->period);
+  }
+
+  return 0;
+}
+
+void gtimer_stats_close() {
+
+  struct gtimer * timer;
+  for (timer = GLIST_BEGIN(timers); timer != GLIST_END(timers); timer = timer->next) {
+    timer->stats = NULL;
+  }
+
+  stats_enabled = 0;
+
+  gstats_close();
+}
@@ -20,6 +20,11 @@ struct gtimer {
     void * user;
     unsigned int period; // in base timer ticks
     unsigned int nexp; // number of base timer ticks since last event
+    struct {
+        uint64_t num; // period, in 1/den 100ns units (0 if the period is rounded to base timer ticks)
+        uint64_t step; // base timer tick, in 1/den 100ns units
+        uint64_t acc; // time since last event, in 1/den 100ns units
+    } exact;
     int (*fp_read)(void * user);
     int (*fp_close)(void * user);
     GLIST_LINK(struct gtimer);
@@ -33,25 +38,42 @@ static int timer_cb(unsigned int nexp) {
 
     struct gtimer * timer;
     for (timer = GLIST_BEGIN(timers); timer != GLIST_END(timers); timer = timer->next) {
-        timer->nexp += nexp;
-        unsigned int divisor = timer->nexp / timer->period;
-        if (divisor >= 1) {
+        int expired;
+        if (timer->exact.num == 0) {
+            timer->nexp += nexp;
+            unsigned int divisor = timer->nexp / timer->period;
+            expired = (divisor >= 1);
+            if (expired) {
+                timer->nexp = 0;
+            }
+        } else {
+            // keep the remainder so that the average period is exact, missed periods are coalesced
+            timer->exact.acc += nexp * timer->exact.step;
+            expired = (timer->exact.acc >= timer->exact.num);
+            if (expired) {
+                timer->exact.acc %= timer->exact.num;
+            }
+        }
+        if (expired) {
             int status = timer->fp_read(timer->user);
             if (status < 0) {
                 ret = -1;
             } else if (ret != -1 && status) {
                 ret = 1;
             }
-            timer->nexp = 0;
         }
     }
 
     return ret;
 }
 
-struct gtimer * gtimer_start(void * user, unsigned int usec, const GTIMER_CALLBACKS * callbacks) {
+/*
+ * Start a timer with a period of num / den 100ns units.
+ * If exact is 0, the period is rounded to the nearest multiple of the base timer period.
+ */
+static struct gtimer * start_timer(void * user, uint64_t num, uint64_t den, int exact, const GTIMER_CALLBACKS * callbacks) {
 
-    if (usec == 0) {
+    if (num == 0) {
         PRINT_ERROR_OTHER("timer period cannot be 0");
         return NULL;
     }
@@ -80,10 +102,8 @@ struct gtimer * gtimer_start(void * user, unsigned int usec, const GTIMER_CALLBA
         return NULL;
     }
     
-    unsigned int requested = usec * 10;
-
     unsigned int lowest = timer_resolution * 9 / 10;
-    if (requested < lowest) {
+    if (num < lowest * den) {
         if (GLOG_LEVEL(GLOG_NAME,ERROR)) {
             fprintf(stderr, "%s:%d %s: timer period should be higher than %dus\n", __FILE__, __LINE__, __func__, lowest / 10);
         }
@@ -91,14 +111,21 @@ struct gtimer * gtimer_start(void * user, unsigned int usec, const GTIMER_CALLBA
         return NULL;
     }
 
-    unsigned int lower = requested / timer_resolution;
-    unsigned int remainder = requested % timer_resolution;
-    unsigned int upper = lower + 1;
-    unsigned int period = (timer_resolution - remainder > remainder) ? lower : upper;
+    unsigned int period = 0;
+
+    if (!exact) {
 
-    if (period * timer_resolution != usec * 10) {
-        if (GLOG_LEVEL(GLOG_NAME,INFO)) {
-            printf("rounding timer period %uus to %uus\n", usec, period * timer_resolution / 10);
+        unsigned int requested = num / den;
+
+        unsigned int lower = requested / timer_resolution;
+        unsigned int remainder = requested % timer_resolution;
+        unsigned int upper = lower + 1;
+        period = (timer_resolution - remainder > remainder) ? lower : upper;
+
+        if (period * timer_resolution != requested) {
+            if (GLOG_LEVEL(GLOG_NAME,INFO)) {
+                printf("rounding timer period %uus to %uus\n", requested / 10, period * timer_resolution / 10);
+            }
         }
     }
 
@@ -112,6 +139,11 @@ struct gtimer * gtimer_start(void * user, unsigned int usec, const GTIMER_CALLBA
     timer->user = user;
     timer->period = period;
     timer->nexp = 0;
+    if (exact) {
+        timer->exact.num = num;
+        timer->exact.step = timer_resolution * den;
+        timer->exact.acc = 0;
+    }
     timer->fp_read = callbacks->fp_read;
     timer->fp_close = callbacks->fp_close;
 
@@ -120,6 +152,64 @@ struct gtimer * gtimer_start(void * user, unsigned int usec, const GTIMER_CALLBA
     return timer;
 }
 
+struct gtimer * gtimer_start(void * user, unsigned int usec, const GTIMER_CALLBACKS * callbacks) {
+
+    return start_timer(user, usec * 10ULL, 1, 0, callbacks);
+}
+
+struct gtimer * gtimer_start_ns(void * user, uint64_t nsec, const GTIMER_CALLBACKS * callbacks) {
+
+    return start_timer(user, nsec, 100, 1, callbacks);
+}
+
+struct gtimer * gtimer_start_rational(void * user, uint64_t num, uint64_t den, const GTIMER_CALLBACKS * callbacks) {
+
+    if (den == 0 || den > UINT32_MAX) {
+        PRINT_ERROR_OTHER("invalid period denominator");
+        return NULL;
+    }
+
+    if (num > UINT64_MAX / 10000000) {
+        PRINT_ERROR_OTHER("timer period is too long");
+        return NULL;
+    }
+
+    return start_timer(user, num * 10000000, den, 1, callbacks);
+}
+
+struct gtimer * gtimer_start_batched(void * user __attribute__((unused)), gtime nsec __attribute__((unused)),
+        const GTIMER_BATCH * batch __attribute__((unused)), const GTIMER_CALLBACKS * callbacks __attribute__((unused))) {
+
+    PRINT_ERROR_OTHER("batched timers are not supported on Windows");
+    return NULL;
+}
+
+struct gtimer * gtimer_start_pll(void * user __attribute__((unused)), unsigned int usec __attribute__((unused)),
+        const GTIMER_PLL * pll __attribute__((unused)), const GTIMER_CALLBACKS * callbacks __attribute__((unused))) {
+
+    PRINT_ERROR_OTHER("phase-locked timers are not supported on Windows");
+    return NULL;
+}
+
+int gtimer_pll_event(struct gtimer * timer __attribute__((unused)), gtime timestamp __attribute__((unused))) {
+
+    PRINT_ERROR_OTHER("phase-locked timers are not supported on Windows");
+    return -1;
+}
+
+int gtimer_pll_get_status(struct gtimer * timer __attribute__((unused)), GTIMER_PLL_STATUS * status __attribute__((unused))) {
+
+    PRINT_ERROR_OTHER("phase-locked timers are not supported on Windows");
+    return -1;
+}
+
+struct gtimer * gtimer_start_shared(void * user __attribute__((unused)), const char * name __attribute__((unused)),
+        unsigned int usec __attribute__((unused)), const GTIMER_CALLBACKS * callbacks __attribute__((unused))) {
+
+    PRINT_ERROR_OTHER("shared timers are not supported on Windows");
+    return NULL;
+}
+
 int gtimer_close(struct gtimer * timer) {
 
     GLIST_REMOVE(timers, timer);
@@ -130,3 +220,36 @@ int gtimer_close(struct gtimer * timer) {
 
     return 1;
 }
+
+int gtimer_set_backend(const char * name __attribute__((unused))) {
+
+    PRINT_ERROR_OTHER("timer backends are not supported on Windows");
+    return -1;
+}
+
+int gtimer_stats_open(const char * name __attribute__((unused))) {
+
+    PRINT_ERROR_OTHER("timer statistics export is not supported on Windows");
+    return -1;
+}
+
+void gtimer_stats_close() {
+
+}
+
+struct gtimeout * gtimeout_start(void * user __attribute__((unused)), unsigned int usec __attribute__((unused)),
+        const GTIMER_CALLBACKS * callbacks __attribute__((unused))) {
+
+    PRINT_ERROR_OTHER("timeouts are not supported on Windows");
+    return NULL;
+}
+
+int gtimeout_reset(struct gtimeout * timeout __attribute__((unused))) {
+
+    return -1;
+}
+
+int gtimeout_close(struct gtimeout * timeout __attribute__((unused))) {
+
+    return -1;
+}
@@ -0,0 +1,160 @@
+/*
+ Copyright (c) 2026 Mathieu Laurendeau <mat.lau@laposte.net>
+ License: GPLv3
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include <gimxpoll/include/gpoll.h>
+#include <gimxtimer/include/gtimer_cyclic.hpp>
+#include <gimxtime/include/gtime.h>
+#include <gimxlog/include/glog.h>
+
+#include <gimxcommon/test/common.h>
+#include <gimxcommon/test/handlers.c>
+
+/*
+ * Runs the period set of gtimer_test from a single timer.
+ */
+
+static unsigned int samples = 0;
+static int debug = 0;
+
+typedef gtimer_cyclic<1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000> executive_t;
+
+static_assert(executive_t::base == 1000, "unexpected base tick");
+static_assert(executive_t::hyperperiod == 2520000, "unexpected hyperperiod");
+static_assert(executive_t::mask(0) == 0x3ff, "all tasks should run in frame 0");
+static_assert(executive_t::mask(1) == 0x001, "only the 1ms task should run in frame 1");
+static_assert(executive_t::mask(6) == 0x027, "the 1ms, 2ms, 3ms and 6ms tasks should run in frame 6");
+
+static executive_t executive;
+
+struct task_test {
+    gtime period;
+    gtime next;
+    gtime sum;
+    unsigned int count;
+};
+
+#define ADD_TEST(PERIOD) { PERIOD * 1000LL, 0, 0, 0 },
+
+static struct task_test tasks[] = {
+    ADD_TEST(1000)
+    ADD_TEST(2000)
+    ADD_TEST(3000)
+    ADD_TEST(4000)
+    ADD_TEST(5000)
+    ADD_TEST(6000)
+    ADD_TEST(7000)
+    ADD_TEST(8000)
+    ADD_TEST(9000)
+    ADD_TEST(10000)
+};
+
+static void usage() {
+  fprintf(stderr, "Usage: ./gtimer_cyclic_test [-d] [-n samples]\n");
+  exit(EXIT_FAILURE);
+}
+
+/*
+ * Reads command-line arguments.
+ */
+static int read_args(int argc, char* argv[]) {
+
+  int opt;
+  while ((opt = getopt(argc, argv, "dn:")) != -1) {
+    switch (opt) {
+    case 'd':
+      debug = 1;
+      break;
+    case 'n':
+      samples = atoi(optarg);
+      break;
+    default: /* '?' */
+      usage();
+      break;
+    }
+  }
+  return 0;
+}
+
+static int timer_close_callback(void * user __attribute__((unused))) {
+  set_done();
+  return 1;
+}
+
+static int task_read_callback(void * user) {
+
+  struct task_test * task = (struct task_test *) user;
+
+  gtime now = gtime_gettime();
+
+  task->sum += llabs((gtimediff) (now - task->next));
+  ++task->count;
+
+  do {
+    task->next += task->period;
+  } while (task->next <= now);
+
+  if (task == tasks + sizeof(tasks) / sizeof(*tasks) - 1 && task->count == samples) {
+    set_done();
+  }
+
+  return 1; // Returning a non-zero value makes gpoll return, allowing to check the 'done' variable.
+}
+
+int main(int argc, char* argv[]) {
+
+  setup_handlers();
+
+  read_args(argc, argv);
+
+  if (debug) {
+    glog_set_level("gimxtimer", E_GLOG_LEVEL_DEBUG);
+  }
+
+  GTIMER_TASK executive_tasks[sizeof(tasks) / sizeof(*tasks)];
+
+  unsigned int i;
+  for (i = 0; i < sizeof(tasks) / sizeof(*tasks); ++i) {
+    executive_tasks[i].user = tasks + i;
+    executive_tasks[i].fp_read = task_read_callback;
+  }
+
+  GTIMER_CALLBACKS timer_callbacks = {
+          .fp_read = NULL,
+          .fp_close = timer_close_callback,
+          .fp_register = REGISTER_FUNCTION,
+          .fp_remove = REMOVE_FUNCTION,
+  };
+
+  gtime start = gtime_gettime();
+  for (i = 0; i < sizeof(tasks) / sizeof(*tasks); ++i) {
+    tasks[i].next = start + tasks[i].period;
+  }
+
+  if (executive.start(executive_tasks, NULL, &timer_callbacks) < 0) {
+    set_done();
+  }
+
+  while(!is_done()) {
+    gpoll();
+  }
+
+  executive.close();
+
+  fprintf(stderr, "Exiting\n");
+
+  printf("task\tperiod\tcount\tdiff\n");
+
+  for (i = 0; i < sizeof(tasks) / sizeof(*tasks); ++i) {
+    if (tasks[i].count) {
+      printf("%d\t" GTIME_FS "us\t%u\t" GTIME_FS "/1K\n", i, tasks[i].period / 1000, tasks[i].count, tasks[i].sum * 1000 / tasks[i].count / tasks[i].period);
+    }
+  }
+
+  return 0;
+}
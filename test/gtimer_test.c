@@ -7,6 +7,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <getopt.h>
+#ifndef WIN32
+#include <unistd.h>
+#endif
 
 #include <gimxpoll/include/gpoll.h>
 #include <gimxtimer/include/gtimer.h>
@@ -21,19 +24,28 @@ static unsigned int samples = 0;
 static int debug = 0;
 static int trace = 0;
 static int prio = 0;
+static const char * stats = NULL;
+static unsigned int ratio = 0;
+static int pll = 0;
+static int rational = 0;
+static int timeout = 0;
+static const char * shared = NULL;
 
 static int slices[] = { 5, 10, 25, 50, 100 };
 
 struct timer_test {
     gtime period;
     struct gtimer * timer;
+    struct gtimer * reference; // event source of phase-locked timers
     gtime next;
     gtime sum;
     unsigned int count;
+    unsigned int ticks; // logical ticks of batched timers
+    unsigned int thirds; // thirds of nanoseconds accumulated by rational timers
     unsigned int slices[sizeof(slices) / sizeof(*slices) + 1];
 };
 
-#define ADD_TEST(PERIOD) { PERIOD * 1000LL, NULL, 0, 0, 0, {} },
+#define ADD_TEST(PERIOD) { PERIOD * 1000LL, NULL, NULL, 0, 0, 0, 0, 0, {} },
 
 static struct timer_test timers[] = {
     ADD_TEST(1000)
@@ -49,7 +61,7 @@ static struct timer_test timers[] = {
 };
 
 static void usage() {
-  fprintf(stderr, "Usage: ./gtimer_test [-d] [-n samples] [-p] [-t]\n");
+  fprintf(stderr, "Usage: ./gtimer_test [-b ratio] [-d] [-e name] [-l] [-n samples] [-o] [-p] [-r] [-s name] [-t]\n");
   exit(EXIT_FAILURE);
 }
 
@@ -59,17 +71,35 @@ static void usage() {
 static int read_args(int argc, char* argv[]) {
 
   int opt;
-  while ((opt = getopt(argc, argv, "dn:pt")) != -1) {
+  while ((opt = getopt(argc, argv, "b:de:ln:oprs:t")) != -1) {
     switch (opt) {
+    case 'b':
+      ratio = atoi(optarg);
+      break;
     case 'd':
       debug = 1;
       break;
+    case 'e':
+      stats = optarg;
+      break;
+    case 'l':
+      pll = 1;
+      break;
     case 'n':
       samples = atoi(optarg);
       break;
+    case 'o':
+      timeout = 1;
+      break;
     case 'p':
       prio = 1;
       break;
+    case 'r':
+      rational = 1;
+      break;
+    case 's':
+      shared = optarg;
+      break;
     case 't':
       trace = 1;
       break;
@@ -125,12 +155,177 @@ static int timer_read_callback(void * user) {
 #else
   do {
     timer->next += timer->period;
+    if (rational && ++timer->thirds == 3) {
+      timer->next += 1;
+      timer->thirds = 0;
+    }
   } while (timer->next <= now);
 #endif
 
   return 1; // Returning a non-zero value makes gpoll return, allowing to check the 'done' variable.
 }
 
+/*
+ * Batched timers wake up at the period of the test, with ratio logical ticks per wakeup.
+ */
+static int timer_batch_callback(void * user, gtime first __attribute__((unused)), gtime period __attribute__((unused)),
+    unsigned int count) {
+
+  struct timer_test * timer = (struct timer_test *) user;
+
+  timer->ticks += count;
+
+  return timer_read_callback(user);
+}
+
+/*
+ * Phase-locked timers are fed by a reference timer that is 0.1% slower.
+ * They should fire half-way between reference events.
+ */
+static int reference_read_callback(void * user) {
+
+  struct timer_test * timer = (struct timer_test *) user;
+
+  gtime now = gtime_gettime();
+
+  timer->next = now + (timer->period + timer->period / 1000) / 2;
+
+  return gtimer_pll_event(timer->timer, now) < 0 ? -1 : 0;
+}
+
+#ifndef WIN32
+#define PENDING_USEC 100000
+#define PENDING_OFFSET_USEC 30000
+
+static struct {
+    struct gtimer * timer;
+    int pipe[2];
+    unsigned int ticks;
+    gtime stall;
+} pending_test = { NULL, { -1, -1 }, 0, 0 };
+
+static int pending_read_callback(void * user __attribute__((unused))) {
+
+  ++pending_test.ticks;
+
+  return 1;
+}
+
+static int feeder_read_callback(void * user __attribute__((unused))) {
+
+  char byte;
+  if (read(pending_test.pipe[0], &byte, sizeof(byte)) < 0) {
+    return -1;
+  }
+
+  return gtimer_pll_event(pending_test.timer, gtime_gettime()) < 0 ? -1 : 1;
+}
+
+/*
+ * An event is fed while a tick of a phase-locked timer is pending, and moves the tick PENDING_OFFSET_USEC
+ * into the future. Both file descriptors are ready in the same gpoll() call, the feeder first:
+ * reading the timer should not wait for the new tick.
+ */
+static void run_pending_test() {
+
+  GTIMER_CALLBACKS timer_callbacks = {
+          .fp_read = pending_read_callback,
+          .fp_close = timer_close_callback,
+          .fp_register = REGISTER_FUNCTION,
+          .fp_remove = REMOVE_FUNCTION,
+  };
+  GTIMER_PLL params = { .bandwidth = 0.05, .offset = PENDING_OFFSET_USEC * 1000LL, .lock_threshold = 0 };
+
+  if (pipe(pending_test.pipe) < 0) {
+    return;
+  }
+
+  pending_test.timer = gtimer_start_pll(NULL, PENDING_USEC, &params, &timer_callbacks);
+  if (pending_test.timer != NULL) {
+
+    GPOLL_CALLBACKS feeder_callbacks = {
+            .fp_read = feeder_read_callback,
+            .fp_write = NULL,
+            .fp_close = timer_close_callback,
+    };
+    if (REGISTER_FUNCTION(pending_test.pipe[0], NULL, &feeder_callbacks) == 0) {
+
+      char byte = 0;
+      if (write(pending_test.pipe[1], &byte, sizeof(byte)) == sizeof(byte)) {
+
+        // let the first tick expire
+        usleep(PENDING_USEC + PENDING_USEC / 10);
+
+        gtime start = gtime_gettime();
+        gpoll();
+        pending_test.stall = gtime_gettime() - start;
+
+        // the tick is delivered once, at its new time
+        while (pending_test.ticks == 0) {
+          gpoll();
+        }
+      }
+
+      REMOVE_FUNCTION(pending_test.pipe[0]);
+    }
+
+    gtimer_close(pending_test.timer);
+  }
+
+  close(pending_test.pipe[0]);
+  close(pending_test.pipe[1]);
+}
+#endif
+
+#define TIMEOUT_USEC 5000
+#define TIMEOUT_RESETS 20
+
+static struct {
+    struct gtimer * resetter;
+    struct gtimeout * timeout;
+    gtime last_reset;
+    unsigned int resets;
+    unsigned int expiries;
+    unsigned int early;
+    int closed;
+} timeout_test = {};
+
+/*
+ * The timeout is reset by a 1ms timer for TIMEOUT_RESETS periods, and expires TIMEOUT_USEC after the last reset.
+ * It is queued again by a reset on its first expiry, and closed from its callback on the second one.
+ */
+static int resetter_read_callback(void * user __attribute__((unused))) {
+
+  if (timeout_test.timeout == NULL || timeout_test.resets == TIMEOUT_RESETS) {
+    return 0;
+  }
+
+  timeout_test.last_reset = gtime_gettime();
+  ++timeout_test.resets;
+
+  return gtimeout_reset(timeout_test.timeout) < 0 ? -1 : 0;
+}
+
+static int timeout_read_callback(void * user __attribute__((unused))) {
+
+  gtime now = gtime_gettime();
+
+  if (now < timeout_test.last_reset + TIMEOUT_USEC * 1000LL) {
+    ++timeout_test.early;
+  }
+
+  if (++timeout_test.expiries == 1) {
+    timeout_test.last_reset = now;
+    return gtimeout_reset(timeout_test.timeout) < 0 ? -1 : 1;
+  }
+
+  gtimeout_close(timeout_test.timeout);
+  timeout_test.timeout = NULL;
+  timeout_test.closed = 1;
+
+  return 1;
+}
+
 int main(int argc, char* argv[]) {
 
   setup_handlers();
@@ -155,6 +350,10 @@ int main(int argc, char* argv[]) {
   	set_done();
   }
 
+  if (stats && gtimer_stats_open(stats) < 0) {
+    set_done();
+  }
+
   unsigned int i;
   for (i = 0; i < sizeof(timers) / sizeof(*timers); ++i) {
 
@@ -164,7 +363,33 @@ int main(int argc, char* argv[]) {
             .fp_register = REGISTER_FUNCTION,
             .fp_remove = REMOVE_FUNCTION,
     };
-    timers[i].timer = gtimer_start(timers + i, timers[i].period / 1000, &timer_callbacks);
+    if (pll) {
+      GTIMER_PLL params = { .bandwidth = 0.05, .offset = timers[i].period / 2, .lock_threshold = 0 };
+      timers[i].timer = gtimer_start_pll(timers + i, timers[i].period / 1000, &params, &timer_callbacks);
+      if (timers[i].timer != NULL) {
+        GTIMER_CALLBACKS reference_callbacks = timer_callbacks;
+        reference_callbacks.fp_read = reference_read_callback;
+        timers[i].reference = gtimer_start_ns(timers + i, timers[i].period + timers[i].period / 1000, &reference_callbacks);
+        if (timers[i].reference == NULL) {
+          set_done();
+          break;
+        }
+      }
+    } else if (rational) {
+      // periods of PERIOD + 1/3 microseconds, i.e. PERIOD * 1000 + 333 + 1/3 nanoseconds
+      timers[i].timer = gtimer_start_rational(timers + i, timers[i].period / 1000 * 3 + 1, 3000000, &timer_callbacks);
+      timers[i].period += 333;
+    } else if (shared) {
+      // run the test in several processes to share the tick sources
+      char name[64];
+      snprintf(name, sizeof(name), "%s-"GTIME_FS, shared, timers[i].period / 1000);
+      timers[i].timer = gtimer_start_shared(timers + i, name, timers[i].period / 1000, &timer_callbacks);
+    } else if (ratio) {
+      GTIMER_BATCH batch = { ratio, timer_batch_callback };
+      timers[i].timer = gtimer_start_batched(timers + i, timers[i].period / ratio, &batch, &timer_callbacks);
+    } else {
+      timers[i].timer = gtimer_start(timers + i, timers[i].period / 1000, &timer_callbacks);
+    }
     if (timers[i].timer == NULL) {
       set_done();
       break;
@@ -173,12 +398,54 @@ int main(int argc, char* argv[]) {
     timers[i].next = gtime_gettime() + timers[i].period;
   }
 
+  if (timeout && !is_done()) {
+
+    GTIMER_CALLBACKS timeout_callbacks = {
+            .fp_read = timeout_read_callback,
+            .fp_close = timer_close_callback,
+            .fp_register = REGISTER_FUNCTION,
+            .fp_remove = REMOVE_FUNCTION,
+    };
+    timeout_test.last_reset = gtime_gettime();
+    timeout_test.timeout = gtimeout_start(NULL, TIMEOUT_USEC, &timeout_callbacks);
+
+    GTIMER_CALLBACKS resetter_callbacks = timeout_callbacks;
+    resetter_callbacks.fp_read = resetter_read_callback;
+    timeout_test.resetter = gtimer_start(NULL, 1000, &resetter_callbacks);
+
+    if (timeout_test.timeout == NULL || timeout_test.resetter == NULL) {
+      set_done();
+    }
+  }
+
   while(!is_done()) {
     gpoll();
   }
 
   for (i = 0; i < sizeof(timers) / sizeof(*timers); ++i) {
-    gtimer_close(timers[i].timer);
+    if (timers[i].reference != NULL) {
+      gtimer_close(timers[i].reference);
+    }
+    if (timers[i].timer != NULL) {
+      gtimer_close(timers[i].timer);
+    }
+  }
+
+#ifndef WIN32
+  if (pll) {
+    run_pending_test();
+  }
+#endif
+
+  if (timeout_test.resetter != NULL) {
+    gtimer_close(timeout_test.resetter);
+  }
+  if (timeout_test.timeout != NULL) {
+    gtimeout_close(timeout_test.timeout);
+  }
+
+  if (stats) {
+    gtimer_stats_close();
   }
 
   if (prio)
@@ -198,7 +465,14 @@ int main(int argc, char* argv[]) {
       printf("\t%d-%d", slices[j - 1], slices[j]);
     }
   }
-  printf("\t>%d\n", slices[j - 1]);
+  printf("\t>%d", slices[j - 1]);
+  if (ratio) {
+    printf("\tticks");
+  }
+  if (pll) {
+    printf("\tlocked\tperiod\terror");
+  }
+  printf("\n");
 
   for (i = 0; i < sizeof(timers) / sizeof(*timers); ++i) {
     if (timers[i].count) {
@@ -206,9 +480,28 @@ int main(int argc, char* argv[]) {
       for (j = 0; j < sizeof(timers[i].slices) / sizeof(*timers[i].slices); ++j) {
         printf("\t%d", timers[i].slices[j]);
       }
+      if (ratio) {
+        printf("\t%u", timers[i].ticks);
+      }
+      GTIMER_PLL_STATUS status;
+      if (pll && gtimer_pll_get_status(timers[i].timer, &status) == 0) {
+        printf("\t%d\t"GTIME_FS"ns\t"GTIMEDIFF_FS"ns", status.locked, status.period, status.error);
+      }
       printf("\n");
     }
   }
 
+#ifndef WIN32
+  if (pll) {
+    printf("pending\tstall\tticks\n");
+    printf("%uus\t"GTIME_FS"us\t%u\n", PENDING_USEC, pending_test.stall / 1000, pending_test.ticks);
+  }
+#endif
+
+  if (timeout) {
+    printf("timeout\tresets\texpiries\tearly\tclosed\n");
+    printf("%uus\t%u\t%u\t%u\t%d\n", TIMEOUT_USEC, timeout_test.resets, timeout_test.expiries, timeout_test.early, timeout_test.closed);
+  }
+
   return 0;
 }
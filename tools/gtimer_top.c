@@ -0,0 +1,142 @@
+/*
+ Copyright (c) 2026 Mathieu Laurendeau <mat.lau@laposte.net>
+ License: GPLv3
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <gimxtimer/include/gtimer_stats.h>
+
+static const char * name = NULL;
+static unsigned int interval = 1;
+static int once = 0;
+
+static void usage() {
+  fprintf(stderr, "Usage: ./gtimer_top [-1] [-i seconds] name\n");
+  exit(EXIT_FAILURE);
+}
+
+/*
+ * Reads command-line arguments.
+ */
+static int read_args(int argc, char* argv[]) {
+
+  int opt;
+  while ((opt = getopt(argc, argv, "1i:")) != -1) {
+    switch (opt) {
+    case '1':
+      once = 1;
+      break;
+    case 'i':
+      interval = atoi(optarg);
+      break;
+    default: /* '?' */
+      usage();
+      break;
+    }
+  }
+  if (optind != argc - 1 || interval == 0) {
+    usage();
+  }
+  name = argv[optind];
+  return 0;
+}
+
+static struct gtimer_stats_timer previous[GTIMER_STATS_MAX_TIMERS] = {};
+
+static void print(const struct gtimer_stats * stats) {
+
+  printf("pid %u\n", stats->pid);
+  printf("slot\tperiod\trate\tcount\tmissed\tcb avg\tcb max\tlateness (us)\n");
+
+  unsigned int i;
+  for (i = 0; i < GTIMER_STATS_MAX_TIMERS; ++i) {
+
+    struct gtimer_stats_timer current;
+    if (gtimer_stats_read(stats->timers + i, &current) < 0) {
+      printf("%u\tinconsistent\n", i);
+      continue;
+    }
+
+    if (current.active == 0) {
+      previous[i].count = 0;
+      continue;
+    }
+
+    uint64_t count = current.count - previous[i].count;
+    if (current.count < previous[i].count) {
+      count = current.count; // slot was reused
+    }
+
+    printf("%u\t%luus\t%lu/s\t%lu\t%lu\t%luns\t%luns\t", i, (unsigned long) (current.period / 1000), (unsigned long) (count / interval),
+        (unsigned long) current.count, (unsigned long) current.missed,
+        (unsigned long) (current.count ? current.cb_total / current.count : 0), (unsigned long) current.cb_max);
+
+    unsigned int j;
+    for (j = 0; j < GTIMER_STATS_LATENESS_BUCKETS; ++j) {
+      if (current.lateness[j]) {
+        if (j == 0) {
+          printf(" <1:%lu", (unsigned long) current.lateness[j]);
+        } else if (j < GTIMER_STATS_LATENESS_BUCKETS - 1) {
+          printf(" <%u:%lu", 1U << j, (unsigned long) current.lateness[j]);
+        } else {
+          printf(" >=%u:%lu", 1U << (j - 1), (unsigned long) current.lateness[j]);
+        }
+      }
+    }
+    printf("\n");
+
+    previous[i] = current;
+  }
+}
+
+int main(int argc, char* argv[]) {
+
+  read_args(argc, argv);
+
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0) {
+    perror("shm_open");
+    return EXIT_FAILURE;
+  }
+
+  struct gtimer_stats * stats = mmap(NULL, sizeof(*stats), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (stats == MAP_FAILED) {
+    perror("mmap");
+    return EXIT_FAILURE;
+  }
+
+  if (__atomic_load_n(&stats->magic, __ATOMIC_ACQUIRE) != GTIMER_STATS_MAGIC) {
+    fprintf(stderr, "%s is not a timer statistics segment\n", name);
+    return EXIT_FAILURE;
+  }
+
+  if (stats->version != GTIMER_STATS_VERSION) {
+    fprintf(stderr, "unsupported statistics version: %u\n", stats->version);
+    return EXIT_FAILURE;
+  }
+
+  for (;;) {
+    if (!once) {
+      printf("\033[H\033[J");
+    }
+    print(stats);
+    fflush(stdout);
+    if (once) {
+      break;
+    }
+    sleep(interval);
+  }
+
+  munmap(stats, sizeof(*stats));
+
+  return 0;
+}